@@ -0,0 +1,182 @@
+#ifndef PHI__define_guard__Benchmark__benchmark_h
+#define PHI__define_guard__Benchmark__benchmark_h
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../define.h"
+#include "../Utility/memory_op.h"
+
+namespace phi {
+namespace bench {
+
+/*
+Shared pieces of the benchmark executables in this directory: a monotonic
+timer, a seeded generator and the Zipf distribution. The generator is
+deterministic so runs compare across builds.
+*/
+
+class Timer {
+public:
+	Timer();
+
+	void Reset();
+
+	double ns() const;
+
+private:
+	std::chrono::steady_clock::time_point begin_;
+};
+
+inline Timer::Timer(): begin_(std::chrono::steady_clock::now()) {}
+
+inline void Timer::Reset() { this->begin_ = std::chrono::steady_clock::now(); }
+
+inline double Timer::ns() const {
+	return std::chrono::duration<double, std::nano>(
+			   std::chrono::steady_clock::now() - this->begin_)
+		.count();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * splitmix64, also used to scatter ranks over the key space.
+*/
+inline unsigned long long Mix(unsigned long long x) {
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+class Random {
+public:
+	explicit Random(unsigned long long seed = 0);
+
+	unsigned long long operator()();
+
+	// uniform in [0, upper)
+	unsigned long long operator()(unsigned long long upper);
+
+	// uniform in [0, 1)
+	double Real();
+
+private:
+	unsigned long long state_;
+};
+
+inline Random::Random(unsigned long long seed): state_(seed) {}
+
+inline unsigned long long Random::operator()() {
+	return Mix(this->state_++);
+}
+
+inline unsigned long long Random::operator()(unsigned long long upper) {
+	return (unsigned long long)((unsigned __int128)(Mix(this->state_++)) *
+								upper >> 64);
+}
+
+inline double Random::Real() {
+	return double(Mix(this->state_++) >> 11) * (1.0 / double(1ULL << 53));
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+Zipf draws ranks in [0, rank_num) with probability proportional to
+1 / (rank + 1)^s, by binary search over the cumulative weights, so rank 0 is
+the most frequent.
+*/
+
+class Zipf {
+public:
+	Zipf(size_t rank_num, double s = 1.0);
+
+	Zipf(const Zipf& zipf) = delete;
+
+	~Zipf();
+
+	Zipf& operator=(const Zipf& zipf) = delete;
+
+	size_t operator()(Random& random) const;
+
+private:
+	size_t rank_num_;
+	double* cdf_;
+};
+
+inline Zipf::Zipf(size_t rank_num, double s):
+	rank_num_(rank_num), cdf_(Malloc<double>(rank_num)) {
+	double sum(0);
+
+	for (size_t i(0); i != rank_num; ++i) {
+		sum += 1 / std::pow(double(i + 1), s);
+		this->cdf_[i] = sum;
+	}
+
+	for (size_t i(0); i != rank_num; ++i) { this->cdf_[i] /= sum; }
+}
+
+inline Zipf::~Zipf() { Free(this->cdf_); }
+
+inline size_t Zipf::operator()(Random& random) const {
+	double x(random.Real());
+
+	size_t lower(0);
+	size_t upper(this->rank_num_ - 1);
+
+	while (lower < upper) {
+		size_t mid((lower + upper) / 2);
+
+		if (this->cdf_[mid] < x) {
+			lower = mid + 1;
+		} else {
+			upper = mid;
+		}
+	}
+
+	return lower;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Keeps the compiler from dropping a computation whose result is unused.
+*/
+template<typename T> void DoNotOptimize(const T& x) {
+	asm volatile("" : : "r,m"(x) : "memory");
+}
+
+/*
+ * Parses a size with an optional K, M or G suffix, powers of 1024.
+*/
+inline size_t ParseSize(const char* str) {
+	char* end;
+	double r(std::strtod(str, &end));
+
+	switch (*end) {
+		case 'k':
+		case 'K': r *= double(1 << 10); break;
+		case 'm':
+		case 'M': r *= double(1 << 20); break;
+		case 'g':
+		case 'G': r *= double(1 << 30); break;
+	}
+
+	return size_t(r);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,682 @@
+/*
+Benchmark of the containers Vector, List, Set, Map, ChainingHashTable and Pool.
+
+	g++ -std=c++17 -O2 -march=native container_benchmark.cpp \
+		-o container_benchmark
+	./container_benchmark [max_size] [filter]
+
+Every container runs six workloads over four key distributions and sizes
+growing fourfold from 1K elements, which fits L1, up to max_size, by default
+enough 16-byte elements to fill ten times the last level cache. Only
+containers whose name contains filter are run.
+
+	insert     inserts size keys into an empty container
+	find-hit   looks up keys present, drawn like the inserted ones
+	find-miss  looks up keys absent from the container
+	erase      erases every key, in shuffled order
+	iterate    walks the whole container
+	mixed      80% find-hit, 10% insert of a new key, 10% erase on a full
+			   container, half inserts and half erases if there is no find
+
+The distributions are sequential and random 8-byte keys, Zipf distributed
+8-byte keys, which repeat, and 24-byte string-like keys sharing a prefix.
+Workloads on sizes below 1M are repeated until about 1M operations are done.
+
+One line is printed per run with the throughput, the p50 and p99 of the time
+per operation and the bytes allocated per element by the full container. The
+percentiles are taken over batches of PHI__bench_batch operations, timing
+each operation alone would measure the clock. Bytes come from counting the
+global operator new[] that Malloc goes through.
+
+Some containers do not have every operation, so they are measured as they are
+used. Vector is a sorted array: find is a binary search over the prefix sorted
+after filling, erase pops the back. List pushes to the back and pops the
+front. Pool hands out blocks a user links together, insert pops a block and
+erase pushes the oldest one back. Those without find skip the find
+workloads. ChainingHashTable and the hashed keys use Mix, so the table rather
+than DefaultHashFunction is measured.
+*/
+
+#include <unistd.h>
+
+#include "benchmark.h"
+#include "../Utility/sort4.h"
+#include "../Container/Vector.h"
+#include "../Container/List.h"
+#include "../Container/Map.h"
+#include "../Container/ChainingHashTable.h"
+#include "../Container/Pool.h"
+
+namespace phi {
+namespace bench {
+
+inline size_t live_bytes(0);
+
+}
+}
+
+/*
+ * Every block carries its size in front so delete[] can subtract it. Both are
+ * kept out of line, g++ warns about the size header when it inlines them.
+*/
+__attribute__((noinline)) void* operator new[](size_t size) {
+	void* ptr(std::malloc(size + 16));
+	if (ptr == nullptr) { throw std::bad_alloc(); }
+
+	*static_cast<size_t*>(ptr) = size;
+	phi::bench::live_bytes += size;
+
+	return static_cast<char*>(ptr) + 16;
+}
+
+__attribute__((noinline)) void operator delete[](void* ptr) noexcept {
+	if (ptr == nullptr) { return; }
+
+	ptr = static_cast<char*>(ptr) - 16;
+	phi::bench::live_bytes -= *static_cast<size_t*>(ptr);
+
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	operator delete[](ptr);
+}
+
+namespace phi {
+namespace bench {
+
+struct String24 {
+	char data[24];
+
+	bool operator<(const String24& str) const {
+		return std::memcmp(this->data, str.data, 24) < 0;
+	}
+
+	bool operator==(const String24& str) const {
+		return std::memcmp(this->data, str.data, 24) == 0;
+	}
+};
+
+template<typename Key> Key MakeKey(unsigned long long num) { return num; }
+
+/*
+ * "key:" and the 16 hex digits of num, zero padded.
+*/
+template<> String24 MakeKey<String24>(unsigned long long num) {
+	String24 r;
+	std::memset(r.data, 0, 24);
+	std::memcpy(r.data, "key:", 4);
+
+	for (size_t i(0); i != 16; ++i) {
+		r.data[19 - i] = "0123456789abcdef"[num & 15];
+		num >>= 4;
+	}
+
+	return r;
+}
+
+unsigned long long KeyNum(unsigned long long key) { return key; }
+
+unsigned long long KeyNum(const String24& key) {
+	unsigned long long r[3];
+	std::memcpy(r, key.data, 24);
+	return r[0] ^ Mix(r[1] ^ Mix(r[2]));
+}
+
+struct KeyHasher {
+	template<typename Key> hash_t operator()(const Key& key) const {
+		return hash_t(Mix(KeyNum(key)));
+	}
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key_> struct VectorAdapter {
+	using Key = Key_;
+	static constexpr bool searchable = true;
+
+	cntr::Vector<Key> c;
+	size_t sorted = 0;
+
+	size_t size() const { return this->c.size(); }
+
+	void Prepare() {
+		Sort(this->c.data(), this->c.data() + this->c.size());
+		this->sorted = this->c.size();
+	}
+
+	void Insert(const Key& key) { this->c.Push(key); }
+
+	bool Find(const Key& key) const {
+		const Key* data(this->c.data());
+		size_t lower(0);
+		size_t upper(this->sorted);
+
+		while (lower < upper) {
+			size_t mid((lower + upper) / 2);
+
+			if (data[mid] < key) {
+				lower = mid + 1;
+			} else {
+				upper = mid;
+			}
+		}
+
+		return lower != this->sorted && data[lower] == key;
+	}
+
+	void Erase(const Key&) {
+		if (this->c.empty()) { return; }
+		this->c.Pop();
+		if (this->c.size() < this->sorted) { this->sorted = this->c.size(); }
+	}
+
+	unsigned long long Iterate() const {
+		unsigned long long r(0);
+		const Key* data(this->c.data());
+		for (size_t i(0); i != this->c.size(); ++i) { r += KeyNum(data[i]); }
+		return r;
+	}
+};
+
+template<typename Key_> struct ListAdapter {
+	using Key = Key_;
+	static constexpr bool searchable = false;
+
+	cntr::List<Key> c;
+
+	size_t size() const { return this->c.size(); }
+
+	void Prepare() {}
+
+	void Insert(const Key& key) { this->c.PushBack(key); }
+
+	bool Find(const Key&) const { return false; }
+
+	void Erase(const Key&) {
+		if (!this->c.empty()) { this->c.PopFront(); }
+	}
+
+	unsigned long long Iterate() const {
+		unsigned long long r(0);
+
+		for (auto i(this->c.first_iterator()), end(this->c.null_iterator());
+			 i != end; ++i) {
+			r += KeyNum(*i);
+		}
+
+		return r;
+	}
+};
+
+template<typename Key_> struct SetAdapter {
+	using Key = Key_;
+	static constexpr bool searchable = true;
+
+	cntr::Set<Key> c;
+
+	size_t size() const { return this->c.size(); }
+
+	void Prepare() {}
+
+	void Insert(const Key& key) { this->c.Insert(key); }
+
+	bool Find(const Key& key) const { return this->c.Contain(key); }
+
+	void Erase(const Key& key) { this->c.FindErase(key); }
+
+	unsigned long long Iterate() const {
+		unsigned long long r(0);
+
+		for (auto i(this->c.first_iterator()), end(this->c.null_iterator());
+			 i != end; ++i) {
+			r += KeyNum(*i);
+		}
+
+		return r;
+	}
+};
+
+template<typename Key_> struct MapAdapter {
+	using Key = Key_;
+	static constexpr bool searchable = true;
+
+	cntr::Map<Key, unsigned long long> c;
+
+	size_t size() const { return this->c.size(); }
+
+	void Prepare() {}
+
+	void Insert(const Key& key) { this->c.Insert(key, KeyNum(key)); }
+
+	bool Find(const Key& key) const {
+		return this->c.Find(key) != this->c.null_iterator();
+	}
+
+	void Erase(const Key& key) { this->c.FindErase(key); }
+
+	unsigned long long Iterate() const {
+		unsigned long long r(0);
+
+		for (auto i(this->c.first_iterator()), end(this->c.null_iterator());
+			 i != end; ++i) {
+			r += i->second;
+		}
+
+		return r;
+	}
+};
+
+template<typename Key_> struct ChainingHashTableAdapter {
+	using Key = Key_;
+	static constexpr bool searchable = true;
+
+	cntr::ChainingHashTable<Key, KeyHasher> c;
+
+	size_t size() const { return this->c.size(); }
+
+	void Prepare() {}
+
+	void Insert(const Key& key) { this->c.Insert(key); }
+
+	bool Find(const Key& key) const { return this->c.Contain(key); }
+
+	void Erase(const Key& key) { this->c.FindErase(key); }
+
+	unsigned long long Iterate() const {
+		unsigned long long r(0);
+
+		for (auto i(this->c.first_iterator()), end(this->c.null_iterator());
+			 i != end; ++i) {
+			r += KeyNum(*i);
+		}
+
+		return r;
+	}
+};
+
+template<typename Key_> struct PoolAdapter {
+	using Key = Key_;
+	static constexpr bool searchable = false;
+
+	struct Block {
+		Block* next;
+		Key key;
+	};
+
+	static constexpr size_t block_size = sizeof(cntr::DoublyNode) <
+												 sizeof(Block)
+											 ? sizeof(Block)
+											 : sizeof(cntr::DoublyNode);
+
+	cntr::Pool<block_size> c;
+
+	// the blocks handed out, oldest first
+	Block* head = nullptr;
+	Block* tail = nullptr;
+	size_t num = 0;
+
+	PoolAdapter() = default;
+
+	PoolAdapter(const PoolAdapter& adapter) = delete;
+
+	~PoolAdapter() {
+		while (this->head != nullptr) {
+			Block* next(this->head->next);
+			Free(this->head);
+			this->head = next;
+		}
+	}
+
+	PoolAdapter& operator=(const PoolAdapter& adapter) = delete;
+
+	size_t size() const { return this->num; }
+
+	void Prepare() {}
+
+	void Insert(const Key& key) {
+		Block* block(static_cast<Block*>(this->c.Pop()));
+		block->next = nullptr;
+		block->key = key;
+
+		if (this->tail == nullptr) {
+			this->head = block;
+		} else {
+			this->tail->next = block;
+		}
+
+		this->tail = block;
+		++this->num;
+	}
+
+	bool Find(const Key&) const { return false; }
+
+	void Erase(const Key&) {
+		if (this->head == nullptr) { return; }
+
+		Block* block(this->head);
+		this->head = block->next;
+		if (this->head == nullptr) { this->tail = nullptr; }
+
+		this->c.Push(block);
+		--this->num;
+	}
+
+	unsigned long long Iterate() const {
+		unsigned long long r(0);
+
+		for (const Block* i(this->head); i != nullptr; i = i->next) {
+			r += KeyNum(i->key);
+		}
+
+		return r;
+	}
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+enum Distribution {
+	sequential_dist,
+	random_dist,
+	zipf_dist,
+	string_dist,
+	distribution_num,
+};
+
+const char* distribution_names[] { "sequential", "random", "zipf", "string" };
+
+/*
+ * Fills the keys to insert, the present keys to look up and the absent ones.
+ * Inserted keys are even and absent keys odd.
+*/
+template<typename Key>
+void Generate(Key* keys, size_t size, Key* hits, Key* misses, size_t op_num,
+			  Distribution dist) {
+	Random random(size * distribution_num + dist);
+
+	switch (dist) {
+		case sequential_dist:
+			for (size_t i(0); i != size; ++i) { keys[i] = MakeKey<Key>(2 * i); }
+			break;
+
+		case zipf_dist: {
+			Zipf zipf(size);
+
+			for (size_t i(0); i != size; ++i) {
+				keys[i] = MakeKey<Key>(Mix(zipf(random)) & ~1ULL);
+			}
+
+			for (size_t i(0); i != op_num; ++i) {
+				hits[i] = MakeKey<Key>(Mix(zipf(random)) & ~1ULL);
+			}
+
+			break;
+		}
+
+		default:
+			for (size_t i(0); i != size; ++i) {
+				keys[i] = MakeKey<Key>(Mix(i) & ~1ULL);
+			}
+			break;
+	}
+
+	if (dist != zipf_dist) {
+		for (size_t i(0); i != op_num; ++i) { hits[i] = keys[random(size)]; }
+	}
+
+	for (size_t i(0); i != op_num; ++i) {
+		misses[i] = MakeKey<Key>(random() | 1);
+	}
+}
+
+template<typename T> void Shuffle(T* data, size_t size, Random& random) {
+	for (size_t i(size); 1 < i; --i) {
+		UncheckedSwap(data[i - 1], data[random(i)]);
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__bench_batch (16)
+#define PHI__bench_min_ops (1 << 20)
+
+/*
+ * Collects the time per operation of the batches of one workload.
+*/
+class Recorder {
+public:
+	Recorder();
+
+	void Add(double ns, size_t op_num);
+
+	template<typename Op> void Run(size_t op_num, Op&& op);
+
+	void Print(const char* container, Distribution dist, size_t size,
+			   const char* workload, double bytes_per_elem);
+
+private:
+	cntr::Vector<double> samples_;
+	double ns_;
+	size_t op_num_;
+};
+
+Recorder::Recorder(): ns_(0), op_num_(0) {}
+
+void Recorder::Add(double ns, size_t op_num) {
+	this->samples_.Push(ns / double(op_num));
+	this->ns_ += ns;
+	this->op_num_ += op_num;
+}
+
+template<typename Op> void Recorder::Run(size_t op_num, Op&& op) {
+	for (size_t i(0); i < op_num; i += PHI__bench_batch) {
+		size_t end(op_num < i + PHI__bench_batch ? op_num
+												 : i + PHI__bench_batch);
+		Timer timer;
+		for (size_t j(i); j != end; ++j) { op(j); }
+		this->Add(timer.ns(), end - i);
+	}
+}
+
+void Recorder::Print(const char* container, Distribution dist, size_t size,
+					 const char* workload, double bytes_per_elem) {
+	size_t n(this->samples_.size());
+	if (n == 0) { return; }
+
+	double* samples(this->samples_.data());
+
+	Nth(n / 2, samples, samples + n);
+	double p50(samples[n / 2]);
+
+	Nth(n * 99 / 100, samples, samples + n);
+	double p99(samples[n * 99 / 100]);
+
+	std::printf("%-18s %-10s %10zu %-9s %10.2f %9.1f %9.1f %9.1f\n",
+				container, distribution_names[dist], size, workload,
+				double(this->op_num_) * 1e3 / this->ns_, p50, p99,
+				bytes_per_elem);
+	std::fflush(stdout);
+}
+
+template<typename Adapter>
+void FillAdapter(Adapter& a, const typename Adapter::Key* keys, size_t size) {
+	for (size_t i(0); i != size; ++i) { a.Insert(keys[i]); }
+	a.Prepare();
+}
+
+template<template<typename> class Adapter, typename Key>
+void Bench(const char* container, size_t size, Distribution dist) {
+	using A = Adapter<Key>;
+
+	size_t rep(size < PHI__bench_min_ops ? PHI__bench_min_ops / size : 1);
+	size_t op_num(size * rep);
+
+	Key* keys(Malloc<Key>(size));
+	Key* hits(Malloc<Key>(op_num));
+	Key* misses(Malloc<Key>(op_num));
+	Key* erased(Malloc<Key>(size));
+
+	Generate(keys, size, hits, misses, op_num, dist);
+
+	Random random(size);
+
+	std::memcpy(erased, keys, sizeof(Key) * size);
+	Shuffle(erased, size, random);
+
+	// bytes per element of a full container
+	double bytes_per_elem;
+
+	{
+		size_t before(live_bytes);
+		A a;
+		FillAdapter(a, keys, size);
+		bytes_per_elem = double(live_bytes - before) / double(a.size());
+	}
+
+	{
+		Recorder recorder;
+
+		for (size_t r(0); r != rep; ++r) {
+			A a;
+			recorder.Run(size, [&](size_t i) { a.Insert(keys[i]); });
+		}
+
+		recorder.Print(container, dist, size, "insert", bytes_per_elem);
+	}
+
+	{
+		A a;
+		FillAdapter(a, keys, size);
+
+		if constexpr (A::searchable) {
+			Recorder hit_recorder;
+			Recorder miss_recorder;
+			size_t found(0);
+
+			hit_recorder.Run(op_num,
+							 [&](size_t i) { found += a.Find(hits[i]); });
+			miss_recorder.Run(op_num,
+							  [&](size_t i) { found += a.Find(misses[i]); });
+
+			DoNotOptimize(found);
+
+			hit_recorder.Print(container, dist, size, "find-hit",
+							   bytes_per_elem);
+			miss_recorder.Print(container, dist, size, "find-miss",
+								bytes_per_elem);
+		}
+
+		Recorder recorder;
+
+		for (size_t r(0); r != rep; ++r) {
+			Timer timer;
+			DoNotOptimize(a.Iterate());
+			recorder.Add(timer.ns(), a.size());
+		}
+
+		recorder.Print(container, dist, size, "iterate", bytes_per_elem);
+	}
+
+	{
+		Recorder recorder;
+
+		for (size_t r(0); r != rep; ++r) {
+			A a;
+			FillAdapter(a, keys, size);
+			recorder.Run(size, [&](size_t i) { a.Erase(erased[i]); });
+		}
+
+		recorder.Print(container, dist, size, "erase", bytes_per_elem);
+	}
+
+	{
+		A a;
+		FillAdapter(a, keys, size);
+
+		Recorder recorder;
+		size_t found(0);
+
+		recorder.Run(op_num, [&](size_t i) {
+			unsigned long long kind(Mix(i) % 10);
+
+			if (!A::searchable) {
+				if (kind < 5) {
+					a.Insert(misses[i]);
+				} else {
+					a.Erase(hits[i]);
+				}
+			} else if (kind < 8) {
+				found += a.Find(hits[i]);
+			} else if (kind == 8) {
+				a.Insert(misses[i]);
+			} else {
+				a.Erase(hits[i]);
+			}
+		});
+
+		DoNotOptimize(found);
+
+		recorder.Print(container, dist, size, "mixed", bytes_per_elem);
+	}
+
+	Free(erased);
+	Free(misses);
+	Free(hits);
+	Free(keys);
+}
+
+template<template<typename> class Adapter>
+void BenchContainer(const char* container, size_t max_size,
+					const char* filter) {
+	if (std::strstr(container, filter) == nullptr) { return; }
+
+	for (size_t size(1 << 10); size <= max_size; size *= 4) {
+		for (int d(0); d != distribution_num; ++d) {
+			Distribution dist(static_cast<Distribution>(d));
+
+			if (dist == string_dist) {
+				Bench<Adapter, String24>(container, size, dist);
+			} else {
+				Bench<Adapter, unsigned long long>(container, size, dist);
+			}
+		}
+	}
+}
+
+#undef PHI__bench_min_ops
+#undef PHI__bench_batch
+
+}
+}
+
+int main(int argc, char** argv) {
+	long llc(sysconf(_SC_LEVEL3_CACHE_SIZE));
+	if (llc <= 0) { llc = sysconf(_SC_LEVEL2_CACHE_SIZE); }
+	if (llc <= 0) { llc = 8 << 20; }
+
+	size_t max_size(argc < 2 ? size_t(llc) * 10 / 16
+							 : phi::bench::ParseSize(argv[1]));
+	const char* filter(argc < 3 ? "" : argv[2]);
+
+	std::printf("last level cache %ld bytes\n", llc);
+	std::printf("%-18s %-10s %10s %-9s %10s %9s %9s %9s\n", "container", "dist",
+				"size", "workload", "Mops/s", "p50 ns", "p99 ns", "B/elem");
+
+	using namespace phi::bench;
+
+	BenchContainer<VectorAdapter>("Vector", max_size, filter);
+	BenchContainer<ListAdapter>("List", max_size, filter);
+	BenchContainer<SetAdapter>("Set", max_size, filter);
+	BenchContainer<MapAdapter>("Map", max_size, filter);
+	BenchContainer<ChainingHashTableAdapter>("ChainingHashTable", max_size,
+											 filter);
+	BenchContainer<PoolAdapter>("Pool", max_size, filter);
+
+	return 0;
+}
@@ -0,0 +1,438 @@
+/*
+Benchmark of the sorting and selection entry points built on Utility/sort4.h.
+
+	g++ -std=c++17 -O2 -march=native -pthread sort_benchmark.cpp \
+		-o sort_benchmark
+	./sort_benchmark [max_size] [filter]
+
+Every algorithm runs over 4- and 8-byte integers, 16-byte pairs and 64-byte
+records, six distributions of keys and sizes from 16 up to max_size (1M by
+default, 100M is the largest size tried). Sizes below 1M are repeated over
+fresh copies of the input until about 1M elements are processed, so timer
+overhead does not count. Only algorithms whose name contains filter are run.
+
+One line is printed per run. ns/elem is the time per element with the
+default comparer, so the sorting networks and other fast paths are used.
+cmp/elem comes from a second run with a counting comparer and is "-" where
+the algorithm does not compare. A run whose output fails the check of its
+algorithm is marked FAIL. StableSort and RadixSort are also run over the
+keys paired with their index, and fail if equal keys change order.
+
+Utility/sort.h and Utility/sort2.h share the include guard of sort4.h and no
+longer compile against the current compare.h and swap.h, so only sort4.h is
+measured.
+*/
+
+#include "benchmark.h"
+#include "../Utility/sort4.h"
+#include "../Utility/radix_sort.h"
+#include "../Utility/incremental_sort.h"
+
+namespace phi {
+namespace bench {
+
+struct Pair16 {
+	unsigned long long key;
+	unsigned long long value;
+
+	bool operator<(const Pair16& pair) const { return this->key < pair.key; }
+};
+
+struct Record64 {
+	unsigned long long key;
+	unsigned long long payload[7];
+
+	bool operator<(const Record64& record) const {
+		return this->key < record.key;
+	}
+};
+
+template<typename T> T MakeElement(unsigned long long key) { return T(key); }
+
+template<> Pair16 MakeElement<Pair16>(unsigned long long key) {
+	return Pair16 { key, ~key };
+}
+
+template<> Record64 MakeElement<Record64>(unsigned long long key) {
+	Record64 r;
+	r.key = key;
+	for (size_t i(0); i != 7; ++i) { r.payload[i] = key + i; }
+	return r;
+}
+
+template<typename T> const char* TypeName();
+template<> const char* TypeName<unsigned int>() { return "u32"; }
+template<> const char* TypeName<unsigned long long>() { return "u64"; }
+template<> const char* TypeName<Pair16>() { return "pair16"; }
+template<> const char* TypeName<Record64>() { return "record64"; }
+
+struct KeyExtractor {
+	unsigned int operator()(unsigned int x) const { return x; }
+	unsigned long long operator()(unsigned long long x) const { return x; }
+	unsigned long long operator()(const Pair16& x) const { return x.key; }
+	unsigned long long operator()(const Record64& x) const { return x.key; }
+};
+
+struct CountingLessThanComparer {
+	size_t* count;
+
+	template<typename X, typename Y> bool lt(const X& x, const Y& y) const {
+		++*this->count;
+		return x < y;
+	}
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+enum Distribution {
+	random_dist,
+	sorted_dist,
+	reverse_dist,
+	organ_pipe_dist,
+	few_unique_dist,
+	zipf_dist,
+	distribution_num,
+};
+
+const char* distribution_names[] { "random",	 "sorted",	   "reverse",
+								   "organ-pipe", "few-unique", "zipf" };
+
+/*
+ * Fills dst with size keys of dist, truncated to the width of T by
+ * MakeElement.
+*/
+template<typename T> void Generate(T* dst, size_t size, Distribution dist) {
+	Random random(size * distribution_num + dist);
+
+	switch (dist) {
+		case random_dist:
+			for (size_t i(0); i != size; ++i) {
+				dst[i] = MakeElement<T>(random());
+			}
+			break;
+
+		case sorted_dist:
+			for (size_t i(0); i != size; ++i) { dst[i] = MakeElement<T>(i); }
+			break;
+
+		case reverse_dist:
+			for (size_t i(0); i != size; ++i) {
+				dst[i] = MakeElement<T>(size - i);
+			}
+			break;
+
+		case organ_pipe_dist:
+			for (size_t i(0); i != size; ++i) {
+				dst[i] = MakeElement<T>(i < size / 2 ? i : size - i);
+			}
+			break;
+
+		case few_unique_dist:
+			for (size_t i(0); i != size; ++i) {
+				dst[i] = MakeElement<T>(random(16));
+			}
+			break;
+
+		case zipf_dist: {
+			Zipf zipf(size < (1 << 20) ? size : (1 << 20));
+
+			// scatter the ranks so frequent keys are not also the least
+			for (size_t i(0); i != size; ++i) {
+				dst[i] = MakeElement<T>(Mix(zipf(random)) >> 1);
+			}
+
+			break;
+		}
+
+		default: break;
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+enum Algorithm {
+	sort_alg,
+	stable_sort_alg,
+	intro_sort_alg,
+	quick_sort_alg,
+	heap_sort_alg,
+	parallel_sort_alg,
+	insertion_sort_alg,
+	selection_sort_alg,
+	bubble_sort_alg,
+	radix_sort_alg,
+	in_place_radix_sort_alg,
+	heap_make_alg,
+	partition_alg,
+	nth_alg,
+	partial_sort_alg,
+	incremental_sort_alg,
+	algorithm_num,
+};
+
+const char* algorithm_names[] {
+	"Sort",
+	"StableSort",
+	"IntroSort",
+	"QuickSort",
+	"HeapSort",
+	"ParallelSort",
+	"InsertionSort",
+	"SelectionSort",
+	"BubbleSort",
+	"RadixSort",
+	"InPlaceRadixSort",
+	"heap::Make",
+	"UnrestrictedPartition",
+	"Nth",
+	"PartialSort",
+	"IncrementalSorter",
+};
+
+// the first k of PartialSort and IncrementalSorter
+#define PHI__bench_top_k (100)
+
+bool Quadratic(Algorithm alg) {
+	return alg == insertion_sort_alg || alg == selection_sort_alg ||
+		   alg == bubble_sort_alg;
+}
+
+bool Stable(Algorithm alg) {
+	return alg == stable_sort_alg || alg == radix_sort_alg;
+}
+
+bool Comparing(Algorithm alg) {
+	return alg != radix_sort_alg && alg != in_place_radix_sort_alg &&
+		   alg != parallel_sort_alg;
+}
+
+template<typename T, typename LessThanComparer>
+void Run(Algorithm alg, T* begin, T* end, LessThanComparer& lt_cmper) {
+	size_t size(end - begin);
+	size_t k(size < PHI__bench_top_k ? size : PHI__bench_top_k);
+
+	switch (alg) {
+		case sort_alg: Sort(begin, end, lt_cmper); break;
+		case stable_sort_alg: StableSort(begin, end, lt_cmper); break;
+		case intro_sort_alg: IntroSort(begin, end, lt_cmper); break;
+		case quick_sort_alg: QuickSort(begin, end, lt_cmper); break;
+		case heap_sort_alg: HeapSort(begin, end, lt_cmper); break;
+		case parallel_sort_alg: ParallelSort(begin, end, lt_cmper); break;
+		case insertion_sort_alg: InsertionSort(begin, end, lt_cmper); break;
+		case selection_sort_alg: SelectionSort(begin, end, lt_cmper); break;
+		case bubble_sort_alg: BubbleSort(begin, end, lt_cmper); break;
+		case radix_sort_alg: RadixSort(begin, end, KeyExtractor()); break;
+
+		case in_place_radix_sort_alg:
+			InPlaceRadixSort(begin, end, KeyExtractor());
+			break;
+
+		case heap_make_alg: heap::Make(begin, end - begin, lt_cmper); break;
+
+		case partition_alg: {
+			T pivot(begin[size / 2]);
+			DoNotOptimize(UnrestrictedPartition(begin, end, pivot, lt_cmper));
+			break;
+		}
+
+		case nth_alg: Nth(size / 2, begin, end, lt_cmper); break;
+
+		case partial_sort_alg:
+			PartialSort(begin, begin + k, end, lt_cmper);
+			break;
+
+		case incremental_sort_alg: {
+			IncrementalSorter<T*, LessThanComparer> sorter(begin, end,
+														   lt_cmper);
+			for (size_t i(0); i != k; ++i) { DoNotOptimize(sorter.Next()); }
+			break;
+		}
+
+		default: break;
+	}
+}
+
+template<typename T> bool IsSorted(const T* begin, const T* end) {
+	for (const T* i(begin + 1); i < end; ++i) {
+		if (*i < *(i - 1)) { return false; }
+	}
+
+	return true;
+}
+
+/*
+ * Checks the output of alg run over [begin, end).
+*/
+template<typename T> bool Check(Algorithm alg, T* begin, T* end) {
+	size_t size(end - begin);
+	size_t k(size < PHI__bench_top_k ? size : PHI__bench_top_k);
+
+	switch (alg) {
+		case heap_make_alg:
+			return heap::IsHeap(begin, end - begin, DefaultLessThanComparer());
+
+		case partition_alg: return true;
+
+		case nth_alg: {
+			for (size_t i(0); i != size; ++i) {
+				if (i < size / 2 ? begin[size / 2] < begin[i]
+								 : begin[i] < begin[size / 2]) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		case partial_sort_alg:
+		case incremental_sort_alg:
+			for (size_t i(k); i < size; ++i) {
+				if (begin[i] < begin[k - 1]) { return false; }
+			}
+
+			return IsSorted(begin, begin + k);
+
+		default: return IsSorted(begin, end);
+	}
+}
+
+/*
+ * Checks that the stable alg keeps equal keys in order. The keys of src are
+ * paired with their index, sorted by key only, and every run of equal keys
+ * must come out with ascending indices.
+*/
+template<typename T>
+bool CheckStable(Algorithm alg, const T* src, size_t size) {
+	Pair16* pairs(Malloc<Pair16>(size));
+
+	for (size_t i(0); i != size; ++i) {
+		pairs[i] = Pair16 { KeyExtractor()(src[i]), i };
+	}
+
+	DefaultLessThanComparer lt_cmper;
+	Run(alg, pairs, pairs + size, lt_cmper);
+
+	bool ok(true);
+
+	for (size_t i(1); ok && i < size; ++i) {
+		ok = pairs[i - 1].key < pairs[i].key ||
+			 (pairs[i - 1].key == pairs[i].key &&
+			  pairs[i - 1].value < pairs[i].value);
+	}
+
+	Free(pairs);
+
+	return ok;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__bench_min_elements (1 << 20)
+#define PHI__bench_max_quadratic_size (4096)
+
+template<typename T>
+void Bench(size_t size, Distribution dist, const char* filter) {
+	size_t rep(size < PHI__bench_min_elements ? PHI__bench_min_elements / size
+											  : 1);
+
+	T* src(Malloc<T>(size));
+	T* work(Malloc<T>(size * rep));
+
+	Generate(src, size, dist);
+
+	for (int a(0); a != algorithm_num; ++a) {
+		Algorithm alg(static_cast<Algorithm>(a));
+
+		if (std::strstr(algorithm_names[alg], filter) == nullptr) { continue; }
+		if (Quadratic(alg) && PHI__bench_max_quadratic_size < size) {
+			continue;
+		}
+
+		// quadratic ones get far fewer repetitions
+		size_t alg_rep(rep);
+
+		if (Quadratic(alg) &&
+			PHI__bench_min_elements * 64 / size / size < alg_rep) {
+			alg_rep = PHI__bench_min_elements * 64 / size / size;
+			if (alg_rep == 0) { alg_rep = 1; }
+		}
+
+		for (size_t r(0); r != alg_rep; ++r) {
+			std::memcpy(work + r * size, src, sizeof(T) * size);
+		}
+
+		DefaultLessThanComparer lt_cmper;
+		Timer timer;
+
+		for (size_t r(0); r != alg_rep; ++r) {
+			Run(alg, work + r * size, work + (r + 1) * size, lt_cmper);
+		}
+
+		double ns(timer.ns());
+		bool ok(Check(alg, work, work + size) &&
+				(!Stable(alg) || CheckStable(alg, src, size)));
+
+		char cmp[32];
+		std::strcpy(cmp, "-");
+
+		if (Comparing(alg)) {
+			size_t count(0);
+			CountingLessThanComparer counting_cmper { &count };
+
+			std::memcpy(work, src, sizeof(T) * size);
+			Run(alg, work, work + size, counting_cmper);
+
+			std::sprintf(cmp, "%.2f", double(count) / double(size));
+		}
+
+		std::printf("%-22s %-9s %-11s %10zu %10.2f %10s%s\n",
+					algorithm_names[alg], TypeName<T>(),
+					distribution_names[dist], size,
+					ns / double(size * alg_rep), cmp, ok ? "" : " FAIL");
+		std::fflush(stdout);
+	}
+
+	Free(work);
+	Free(src);
+}
+
+template<typename T> void BenchType(size_t max_size, const char* filter) {
+	const size_t sizes[] { 16,		  256,		 4096,		1 << 16,
+						   1 << 20, 1 << 24, 100000000 };
+
+	for (size_t size : sizes) {
+		if (max_size < size) { break; }
+
+		for (int d(0); d != distribution_num; ++d) {
+			Bench<T>(size, Distribution(d), filter);
+		}
+	}
+}
+
+#undef PHI__bench_max_quadratic_size
+#undef PHI__bench_min_elements
+#undef PHI__bench_top_k
+
+}
+}
+
+int main(int argc, char** argv) {
+	size_t max_size(argc < 2 ? (1 << 20) : phi::bench::ParseSize(argv[1]));
+	const char* filter(argc < 3 ? "" : argv[2]);
+
+	std::printf("%-22s %-9s %-11s %10s %10s %10s\n", "algorithm", "type",
+				"dist", "size", "ns/elem", "cmp/elem");
+
+	phi::bench::BenchType<unsigned int>(max_size, filter);
+	phi::bench::BenchType<unsigned long long>(max_size, filter);
+	phi::bench::BenchType<phi::bench::Pair16>(max_size, filter);
+	phi::bench::BenchType<phi::bench::Record64>(max_size, filter);
+
+	return 0;
+}
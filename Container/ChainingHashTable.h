@@ -192,6 +192,13 @@ public:
 
 	ChainingHashTable(Hasher hasher = Hasher(),
 					  EqualComparer eq_cmper = EqualComparer());
+	ChainingHashTable(const ChainingHashTable& cht) = delete;
+
+	~ChainingHashTable();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	ChainingHashTable& operator=(const ChainingHashTable& cht) = delete;
 
 #///////////////////////////////////////////////////////////////////////////////
 
@@ -319,7 +326,7 @@ ChainingHashTable<T, Hasher, EqualComparer>::next_node_(
 	const Node* node) const {
 	if (node == nullptr) { return this->first_node_(); }
 
-	DoublyNode* d_node(node->next());
+	DoublyNode* d_node(const_cast<DoublyNode*>(node->next()));
 	size_t d_node_addr(PHI__void_ptr_addr(d_node));
 	size_t bucket_addr(PHI__void_ptr_addr(this->bucket_));
 
@@ -348,7 +355,7 @@ ChainingHashTable<T, Hasher, EqualComparer>::prev_node_(
 	const Node* node) const {
 	if (node == nullptr) { return this->last_node_(); }
 
-	DoublyNode* d_node(node->prev());
+	DoublyNode* d_node(const_cast<DoublyNode*>(node->prev()));
 	size_t d_node_addr(PHI__void_ptr_addr(d_node));
 	size_t bucket_addr(PHI__void_ptr_addr(this->bucket_));
 
@@ -442,6 +449,21 @@ ChainingHashTable<T, Hasher, EqualComparer>::ChainingHashTable(
 	}
 }
 
+template<typename T, typename Hasher, typename EqualComparer>
+ChainingHashTable<T, Hasher, EqualComparer>::~ChainingHashTable() {
+	for (size_t i(0); i != this->bucket_size_; ++i) {
+		BucketNode* bucket_node(this->bucket_ + i);
+
+		while (!bucket_node->sole()) {
+			Node* node(static_cast<Node*>(bucket_node->next()->Pop()));
+			node->~Node();
+			Free(node);
+		}
+	}
+
+	Delete(this->bucket_size_, this->bucket_);
+}
+
 #///////////////////////////////////////////////////////////////////////////////
 
 template<typename T, typename Hasher, typename EqualComparer>
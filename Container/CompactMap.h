@@ -0,0 +1,20 @@
+#ifndef PHI__define_guard__Container__CompactMap_h
+#define PHI__define_guard__Container__CompactMap_h
+
+#include "../Utility/pair.h"
+#include "../Utility/compare.h"
+#include "Map.h"
+#include "CompactSet.h"
+
+namespace phi {
+namespace cntr {
+
+template<typename Index, typename Value,
+		 typename FullComparer = DefaultFullComparer>
+using CompactMap =
+	CompactSet<pair<Index, Value>, MapFullComparer<Index, Value, FullComparer>>;
+
+}
+}
+
+#endif
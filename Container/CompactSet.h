@@ -0,0 +1,1084 @@
+#ifndef PHI__define_guard__Container__CompactSet_h
+#define PHI__define_guard__Container__CompactSet_h
+
+#include "../Utility/memory_op.h"
+#include "../Utility/pair.h"
+#include "../Utility/compare.h"
+#include "Vector.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+CompactSet is a red-black tree whose nodes live in a Vector arena. Links are
+32-bit indices into the arena and the color is packed into the highest bit of
+the parent index, so a node costs three id_t besides its value (no vtable, no
+padding for the color). The arena holds no pointers, so a CompactSet can be
+copied with its Vector, serialized or mapped as it is.
+
+Erase moves the last node of the arena into the hole, so erasing invalidates
+iterators to the last node as well as the erased one.
+*/
+
+template<typename T, typename FullComparer = DefaultFullComparer>
+class CompactSet {
+public:
+	static constexpr bool black = false;
+	static constexpr bool red = true;
+
+	static constexpr id_t null_id = ~id_t(0) >> 1;
+	static constexpr id_t color_bit = ~null_id;
+
+	class Iterator;
+	class ConstIterator;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	struct Node {
+		friend class CompactSet;
+
+		T value;
+
+		template<typename... Args> Node(Args&&... args);
+
+		Node(Node& node);
+		Node(const Node& node);
+		Node(Node&& node);
+
+		Node& operator=(const Node& node);
+		Node& operator=(Node&& node);
+
+	private:
+		id_t pc_; // parent id in the low bits, color in color_bit
+		id_t l_;
+		id_t r_;
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	class Iterator {
+		friend class CompactSet;
+
+	public:
+		Iterator(const Iterator& iter);
+
+		Iterator& operator=(const Iterator& iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		T& operator*() const;
+		T* operator->() const;
+
+		Iterator& operator++();
+		Iterator& operator--();
+
+	private:
+		CompactSet* set_;
+		id_t id_;
+
+		Iterator(CompactSet* set, id_t id);
+	};
+
+	class ConstIterator {
+		friend class CompactSet;
+
+	public:
+		ConstIterator(const Iterator& iter);
+		ConstIterator(const ConstIterator& const_iter);
+
+		ConstIterator& operator=(const Iterator& iter);
+		ConstIterator& operator=(const ConstIterator& const_iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		const T& operator*() const;
+		const T* operator->() const;
+
+		ConstIterator& operator++();
+		ConstIterator& operator--();
+
+	private:
+		const CompactSet* set_;
+		id_t id_;
+
+		ConstIterator(const CompactSet* set, id_t id);
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const;
+	size_t capacity() const;
+	bool empty() const;
+
+	FullComparer& full_cmper();
+	const FullComparer& full_cmper() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	Iterator first_iterator();
+	Iterator last_iterator();
+	Iterator null_iterator();
+
+	ConstIterator first_iterator() const;
+	ConstIterator last_iterator() const;
+	ConstIterator null_iterator() const;
+
+	ConstIterator first_const_iterator() const;
+	ConstIterator last_const_iterator() const;
+	ConstIterator null_const_iterator() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	CompactSet(const FullComparer& full_cmper = FullComparer());
+	CompactSet(const CompactSet& set);
+	CompactSet(CompactSet&& set);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	CompactSet& operator=(const CompactSet& set);
+	CompactSet& operator=(CompactSet&& set);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool operator==(const CompactSet& set) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> bool Contain(const Index& index) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> Iterator Find(const Index& index);
+	template<typename Index> ConstIterator Find(const Index& index) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename... Args> pair<Iterator, bool> Insert(Args&&... args);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	Iterator Erase(const Iterator& iter);
+	template<typename Index> bool FindErase(const Index& index);
+
+	void Clear();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	void Reserve(size_t capacity);
+
+	void Check() const;
+
+private:
+	Vector<Node> nodes_;
+	id_t root_;
+
+	FullComparer full_cmper_;
+
+	id_t p_(id_t id) const;
+	bool color_(id_t id) const;
+
+	void set_p_(id_t id, id_t p);
+	void set_color_(id_t id, bool color);
+
+	id_t most_l_(id_t id) const;
+	id_t most_r_(id_t id) const;
+
+	id_t next_(id_t id) const;
+	id_t prev_(id_t id) const;
+
+	template<typename Index> id_t Find_(const Index& index) const;
+
+	void RotateL_(id_t id);
+	void RotateR_(id_t id);
+
+	void InsertFix_(id_t id);
+
+	void Transplant_(id_t u, id_t v);
+	void Release_(id_t id);
+	void ReleaseFix_(id_t x, id_t xp);
+
+	void Relocate_(id_t from, id_t to);
+
+	size_t Check_(id_t id) const;
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+CompactSet<T, FullComparer>::Node::Node(Args&&... args):
+	value(Forward<Args>(args)...), pc_(null_id), l_(null_id), r_(null_id) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::Node::Node(Node& node):
+	Node(static_cast<const Node&>(node)) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::Node::Node(const Node& node):
+	value(node.value), pc_(node.pc_), l_(node.l_), r_(node.r_) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::Node::Node(Node&& node):
+	value(Move(node.value)), pc_(node.pc_), l_(node.l_), r_(node.r_) {}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Node&
+CompactSet<T, FullComparer>::Node::operator=(const Node& node) {
+	this->value = node.value;
+	this->pc_ = node.pc_;
+	this->l_ = node.l_;
+	this->r_ = node.r_;
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Node&
+CompactSet<T, FullComparer>::Node::operator=(Node&& node) {
+	this->value = Move(node.value);
+	this->pc_ = node.pc_;
+	this->l_ = node.l_;
+	this->r_ = node.r_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+size_t CompactSet<T, FullComparer>::size() const {
+	return this->nodes_.size();
+}
+
+template<typename T, typename FullComparer>
+size_t CompactSet<T, FullComparer>::capacity() const {
+	return this->nodes_.capacity();
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::empty() const {
+	return this->nodes_.empty();
+}
+
+template<typename T, typename FullComparer>
+FullComparer& CompactSet<T, FullComparer>::full_cmper() {
+	return this->full_cmper_;
+}
+
+template<typename T, typename FullComparer>
+const FullComparer& CompactSet<T, FullComparer>::full_cmper() const {
+	return this->full_cmper_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Iterator
+CompactSet<T, FullComparer>::first_iterator() {
+	return Iterator(this, this->most_l_(this->root_));
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Iterator
+CompactSet<T, FullComparer>::last_iterator() {
+	return Iterator(this, this->most_r_(this->root_));
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Iterator
+CompactSet<T, FullComparer>::null_iterator() {
+	return Iterator(this, null_id);
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator
+CompactSet<T, FullComparer>::first_iterator() const {
+	return ConstIterator(this, this->most_l_(this->root_));
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator
+CompactSet<T, FullComparer>::last_iterator() const {
+	return ConstIterator(this, this->most_r_(this->root_));
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator
+CompactSet<T, FullComparer>::null_iterator() const {
+	return ConstIterator(this, null_id);
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator
+CompactSet<T, FullComparer>::first_const_iterator() const {
+	return ConstIterator(this, this->most_l_(this->root_));
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator
+CompactSet<T, FullComparer>::last_const_iterator() const {
+	return ConstIterator(this, this->most_r_(this->root_));
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator
+CompactSet<T, FullComparer>::null_const_iterator() const {
+	return ConstIterator(this, null_id);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::CompactSet(const FullComparer& full_cmper):
+	root_(null_id), full_cmper_(full_cmper) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::CompactSet(const CompactSet& set):
+	nodes_(set.nodes_), root_(set.root_), full_cmper_(set.full_cmper_) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::CompactSet(CompactSet&& set):
+	nodes_(Move(set.nodes_)), root_(set.root_),
+	full_cmper_(Move(set.full_cmper_)) {
+	set.root_ = null_id;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>&
+CompactSet<T, FullComparer>::operator=(const CompactSet& set) {
+	this->nodes_ = set.nodes_;
+	this->root_ = set.root_;
+	this->full_cmper_ = set.full_cmper_;
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>&
+CompactSet<T, FullComparer>::operator=(CompactSet&& set) {
+	this->nodes_ = Move(set.nodes_);
+	this->root_ = set.root_;
+	this->full_cmper_ = Move(set.full_cmper_);
+	set.root_ = null_id;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::operator==(const CompactSet& set) const {
+	if (this == &set) { return true; }
+	if (this->size() != set.size()) { return false; }
+
+	id_t n(this->most_l_(this->root_));
+	id_t m(set.most_l_(set.root_));
+
+	for (; n != null_id; n = this->next_(n), m = set.next_(m)) {
+		if (this->full_cmper_(this->nodes_[n].value, set.nodes_[m].value) !=
+			0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+id_t CompactSet<T, FullComparer>::p_(id_t id) const {
+	return this->nodes_[id].pc_ & null_id;
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::color_(id_t id) const {
+	return id != null_id && (this->nodes_[id].pc_ & color_bit);
+}
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::set_p_(id_t id, id_t p) {
+	this->nodes_[id].pc_ = (this->nodes_[id].pc_ & color_bit) | p;
+}
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::set_color_(id_t id, bool color) {
+	this->nodes_[id].pc_ =
+		(this->nodes_[id].pc_ & null_id) | (color ? color_bit : 0);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+id_t CompactSet<T, FullComparer>::most_l_(id_t id) const {
+	if (id == null_id) { return null_id; }
+	while (this->nodes_[id].l_ != null_id) { id = this->nodes_[id].l_; }
+	return id;
+}
+
+template<typename T, typename FullComparer>
+id_t CompactSet<T, FullComparer>::most_r_(id_t id) const {
+	if (id == null_id) { return null_id; }
+	while (this->nodes_[id].r_ != null_id) { id = this->nodes_[id].r_; }
+	return id;
+}
+
+template<typename T, typename FullComparer>
+id_t CompactSet<T, FullComparer>::next_(id_t id) const {
+	if (this->nodes_[id].r_ != null_id) {
+		return this->most_l_(this->nodes_[id].r_);
+	}
+
+	id_t p(this->p_(id));
+
+	while (p != null_id && this->nodes_[p].r_ == id) {
+		id = p;
+		p = this->p_(p);
+	}
+
+	return p;
+}
+
+template<typename T, typename FullComparer>
+id_t CompactSet<T, FullComparer>::prev_(id_t id) const {
+	if (this->nodes_[id].l_ != null_id) {
+		return this->most_r_(this->nodes_[id].l_);
+	}
+
+	id_t p(this->p_(id));
+
+	while (p != null_id && this->nodes_[p].l_ == id) {
+		id = p;
+		p = this->p_(p);
+	}
+
+	return p;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename Index>
+id_t CompactSet<T, FullComparer>::Find_(const Index& index) const {
+	for (id_t n(this->root_); n != null_id;) {
+		switch (this->full_cmper_(index, this->nodes_[n].value)) {
+			case -1: n = this->nodes_[n].l_; break;
+			case 1: n = this->nodes_[n].r_; break;
+			case 0: return n;
+		}
+	}
+
+	return null_id;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool CompactSet<T, FullComparer>::Contain(const Index& index) const {
+	return this->Find_(index) != null_id;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename CompactSet<T, FullComparer>::Iterator
+CompactSet<T, FullComparer>::Find(const Index& index) {
+	return Iterator(this, this->Find_(index));
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename CompactSet<T, FullComparer>::ConstIterator
+CompactSet<T, FullComparer>::Find(const Index& index) const {
+	return ConstIterator(this, this->Find_(index));
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::RotateL_(id_t id) {
+	id_t r(this->nodes_[id].r_);
+	id_t p(this->p_(id));
+
+	this->nodes_[id].r_ = this->nodes_[r].l_;
+	if (this->nodes_[r].l_ != null_id) { this->set_p_(this->nodes_[r].l_, id); }
+
+	this->set_p_(r, p);
+
+	if (p == null_id) {
+		this->root_ = r;
+	} else if (this->nodes_[p].l_ == id) {
+		this->nodes_[p].l_ = r;
+	} else {
+		this->nodes_[p].r_ = r;
+	}
+
+	this->nodes_[r].l_ = id;
+	this->set_p_(id, r);
+}
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::RotateR_(id_t id) {
+	id_t l(this->nodes_[id].l_);
+	id_t p(this->p_(id));
+
+	this->nodes_[id].l_ = this->nodes_[l].r_;
+	if (this->nodes_[l].r_ != null_id) { this->set_p_(this->nodes_[l].r_, id); }
+
+	this->set_p_(l, p);
+
+	if (p == null_id) {
+		this->root_ = l;
+	} else if (this->nodes_[p].l_ == id) {
+		this->nodes_[p].l_ = l;
+	} else {
+		this->nodes_[p].r_ = l;
+	}
+
+	this->nodes_[l].r_ = id;
+	this->set_p_(id, l);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::InsertFix_(id_t n) {
+	id_t p;
+
+	while ((p = this->p_(n)) != null_id && this->color_(p) == red) {
+		id_t g(this->p_(p));
+
+		if (p == this->nodes_[g].l_) {
+			id_t u(this->nodes_[g].r_);
+
+			if (this->color_(u) == red) {
+				this->set_color_(p, black);
+				this->set_color_(u, black);
+				this->set_color_(g, red);
+				n = g;
+				continue;
+			}
+
+			if (n == this->nodes_[p].r_) {
+				this->RotateL_(p);
+				n = p;
+				p = this->p_(n);
+			}
+
+			this->set_color_(p, black);
+			this->set_color_(g, red);
+			this->RotateR_(g);
+		} else {
+			id_t u(this->nodes_[g].l_);
+
+			if (this->color_(u) == red) {
+				this->set_color_(p, black);
+				this->set_color_(u, black);
+				this->set_color_(g, red);
+				n = g;
+				continue;
+			}
+
+			if (n == this->nodes_[p].l_) {
+				this->RotateR_(p);
+				n = p;
+				p = this->p_(n);
+			}
+
+			this->set_color_(p, black);
+			this->set_color_(g, red);
+			this->RotateL_(g);
+		}
+	}
+
+	this->set_color_(this->root_, black);
+}
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+pair<typename CompactSet<T, FullComparer>::Iterator, bool>
+CompactSet<T, FullComparer>::Insert(Args&&... args) {
+	PHI__debug_if(null_id <= this->size()) { PHI__throw("size overflow"); }
+
+	id_t node(this->size());
+	this->nodes_.Push(Forward<Args>(args)...);
+
+	if (this->root_ == null_id) {
+		this->root_ = node;
+		return pair<Iterator, bool>(Iterator(this, node), true);
+	}
+
+	id_t n(this->root_);
+
+	for (;;) {
+		switch (this->full_cmper_(this->nodes_[node].value,
+								  this->nodes_[n].value)) {
+			case -1:
+				if (this->nodes_[n].l_ == null_id) {
+					this->nodes_[n].l_ = node;
+					goto insert_complete;
+				}
+
+				n = this->nodes_[n].l_;
+				break;
+			case 1:
+				if (this->nodes_[n].r_ == null_id) {
+					this->nodes_[n].r_ = node;
+					goto insert_complete;
+				}
+
+				n = this->nodes_[n].r_;
+				break;
+			case 0:
+				this->nodes_.Pop();
+				return pair<Iterator, bool>(Iterator(this, n), false);
+		}
+	}
+
+insert_complete:;
+
+	this->nodes_[node].pc_ = n | color_bit;
+	this->InsertFix_(node);
+
+	return pair<Iterator, bool>(Iterator(this, node), true);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::Transplant_(id_t u, id_t v) {
+	id_t p(this->p_(u));
+
+	if (p == null_id) {
+		this->root_ = v;
+	} else if (this->nodes_[p].l_ == u) {
+		this->nodes_[p].l_ = v;
+	} else {
+		this->nodes_[p].r_ = v;
+	}
+
+	if (v != null_id) { this->set_p_(v, p); }
+}
+
+/*
+ * Unlinks id from the tree, its slot in the arena is left untouched.
+*/
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::Release_(id_t z) {
+	bool color(this->color_(z));
+	id_t x;
+	id_t xp;
+
+	if (this->nodes_[z].l_ == null_id) {
+		x = this->nodes_[z].r_;
+		xp = this->p_(z);
+		this->Transplant_(z, x);
+	} else if (this->nodes_[z].r_ == null_id) {
+		x = this->nodes_[z].l_;
+		xp = this->p_(z);
+		this->Transplant_(z, x);
+	} else {
+		id_t y(this->most_l_(this->nodes_[z].r_));
+		color = this->color_(y);
+		x = this->nodes_[y].r_;
+
+		if (this->p_(y) == z) {
+			xp = y;
+		} else {
+			xp = this->p_(y);
+			this->Transplant_(y, x);
+			this->nodes_[y].r_ = this->nodes_[z].r_;
+			this->set_p_(this->nodes_[y].r_, y);
+		}
+
+		this->Transplant_(z, y);
+		this->nodes_[y].l_ = this->nodes_[z].l_;
+		this->set_p_(this->nodes_[y].l_, y);
+		this->set_color_(y, this->color_(z));
+	}
+
+	if (color == black) { this->ReleaseFix_(x, xp); }
+}
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::ReleaseFix_(id_t x, id_t xp) {
+	while (x != this->root_ && this->color_(x) == black) {
+		if (x == this->nodes_[xp].l_) {
+			id_t w(this->nodes_[xp].r_);
+
+			if (this->color_(w) == red) {
+				this->set_color_(w, black);
+				this->set_color_(xp, red);
+				this->RotateL_(xp);
+				w = this->nodes_[xp].r_;
+			}
+
+			if (this->color_(this->nodes_[w].l_) == black &&
+				this->color_(this->nodes_[w].r_) == black) {
+				this->set_color_(w, red);
+				x = xp;
+				xp = this->p_(x);
+				continue;
+			}
+
+			if (this->color_(this->nodes_[w].r_) == black) {
+				this->set_color_(this->nodes_[w].l_, black);
+				this->set_color_(w, red);
+				this->RotateR_(w);
+				w = this->nodes_[xp].r_;
+			}
+
+			this->set_color_(w, this->color_(xp));
+			this->set_color_(xp, black);
+			this->set_color_(this->nodes_[w].r_, black);
+			this->RotateL_(xp);
+		} else {
+			id_t w(this->nodes_[xp].l_);
+
+			if (this->color_(w) == red) {
+				this->set_color_(w, black);
+				this->set_color_(xp, red);
+				this->RotateR_(xp);
+				w = this->nodes_[xp].l_;
+			}
+
+			if (this->color_(this->nodes_[w].l_) == black &&
+				this->color_(this->nodes_[w].r_) == black) {
+				this->set_color_(w, red);
+				x = xp;
+				xp = this->p_(x);
+				continue;
+			}
+
+			if (this->color_(this->nodes_[w].l_) == black) {
+				this->set_color_(this->nodes_[w].r_, black);
+				this->set_color_(w, red);
+				this->RotateL_(w);
+				w = this->nodes_[xp].l_;
+			}
+
+			this->set_color_(w, this->color_(xp));
+			this->set_color_(xp, black);
+			this->set_color_(this->nodes_[w].l_, black);
+			this->RotateR_(xp);
+		}
+
+		x = this->root_;
+	}
+
+	if (x != null_id) { this->set_color_(x, black); }
+}
+
+/*
+ * Moves the node in slot from to the unlinked slot to and fixes its links.
+*/
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::Relocate_(id_t from, id_t to) {
+	this->nodes_[to] = Move(this->nodes_[from]);
+
+	id_t p(this->p_(to));
+
+	if (p == null_id) {
+		this->root_ = to;
+	} else if (this->nodes_[p].l_ == from) {
+		this->nodes_[p].l_ = to;
+	} else {
+		this->nodes_[p].r_ = to;
+	}
+
+	if (this->nodes_[to].l_ != null_id) { this->set_p_(this->nodes_[to].l_, to); }
+	if (this->nodes_[to].r_ != null_id) { this->set_p_(this->nodes_[to].r_, to); }
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Iterator
+CompactSet<T, FullComparer>::Erase(const Iterator& iter) {
+	PHI__debug_if(this != iter.set_) { PHI__throw("iter error"); }
+	if (iter.id_ == null_id) { return Iterator(this, null_id); }
+
+	id_t next(this->next_(iter.id_));
+	id_t last(this->size() - 1);
+
+	this->Release_(iter.id_);
+
+	if (iter.id_ != last) {
+		this->Relocate_(last, iter.id_);
+		if (next == last) { next = iter.id_; }
+	}
+
+	this->nodes_.Pop();
+
+	return Iterator(this, next);
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool CompactSet<T, FullComparer>::FindErase(const Index& index) {
+	id_t id(this->Find_(index));
+	if (id == null_id) { return false; }
+
+	id_t last(this->size() - 1);
+
+	this->Release_(id);
+	if (id != last) { this->Relocate_(last, id); }
+	this->nodes_.Pop();
+
+	return true;
+}
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::Clear() {
+	this->nodes_.Clear();
+	this->root_ = null_id;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::Reserve(size_t capacity) {
+	this->nodes_.Reserve(capacity);
+}
+
+template<typename T, typename FullComparer>
+size_t CompactSet<T, FullComparer>::Check_(id_t id) const {
+	if (id == null_id) { return 0; }
+
+	id_t l(this->nodes_[id].l_);
+	id_t r(this->nodes_[id].r_);
+
+	if ((l != null_id && this->p_(l) != id) ||
+		(r != null_id && this->p_(r) != id)) {
+		std::cout << "link error\n";
+	}
+
+	if (this->color_(id) == red &&
+		(this->color_(l) == red || this->color_(r) == red)) {
+		std::cout << "color error\n";
+	}
+
+	size_t l_bh(this->Check_(l));
+	size_t r_bh(this->Check_(r));
+
+	if (l_bh != r_bh) { std::cout << "bh error\n"; }
+
+	return this->color_(id) == black ? l_bh + 1 : l_bh;
+}
+
+template<typename T, typename FullComparer>
+void CompactSet<T, FullComparer>::Check() const {
+	if (this->color_(this->root_) == red) { std::cout << "root color error\n"; }
+	this->Check_(this->root_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::Iterator::Iterator(const Iterator& iter):
+	set_(iter.set_), id_(iter.id_) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::Iterator::Iterator(CompactSet* set, id_t id):
+	set_(set), id_(id) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Iterator&
+CompactSet<T, FullComparer>::Iterator::operator=(const Iterator& iter) {
+	this->set_ = iter.set_;
+	this->id_ = iter.id_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::Iterator::operator==(
+	const Iterator& iter) const {
+	return this->id_ == iter.id_ && this->set_ == iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::Iterator::operator!=(
+	const Iterator& iter) const {
+	return this->id_ != iter.id_ || this->set_ != iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::Iterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->id_ == const_iter.id_ && this->set_ == const_iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::Iterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return this->id_ != const_iter.id_ || this->set_ != const_iter.set_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+T& CompactSet<T, FullComparer>::Iterator::operator*() const {
+	PHI__debug_if(this->id_ == null_id) { PHI__throw("iter error"); }
+	return this->set_->nodes_[this->id_].value;
+}
+
+template<typename T, typename FullComparer>
+T* CompactSet<T, FullComparer>::Iterator::operator->() const {
+	PHI__debug_if(this->id_ == null_id) { PHI__throw("iter error"); }
+	return &this->set_->nodes_[this->id_].value;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Iterator&
+CompactSet<T, FullComparer>::Iterator::operator++() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+
+	this->id_ = this->id_ == null_id ? this->set_->most_l_(this->set_->root_)
+									 : this->set_->next_(this->id_);
+
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::Iterator&
+CompactSet<T, FullComparer>::Iterator::operator--() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+
+	this->id_ = this->id_ == null_id ? this->set_->most_r_(this->set_->root_)
+									 : this->set_->prev_(this->id_);
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::ConstIterator::ConstIterator(const Iterator& iter):
+	set_(iter.set_), id_(iter.id_) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::ConstIterator::ConstIterator(
+	const ConstIterator& const_iter):
+	set_(const_iter.set_),
+	id_(const_iter.id_) {}
+
+template<typename T, typename FullComparer>
+CompactSet<T, FullComparer>::ConstIterator::ConstIterator(const CompactSet* set,
+														  id_t id):
+	set_(set),
+	id_(id) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator&
+CompactSet<T, FullComparer>::ConstIterator::operator=(const Iterator& iter) {
+	this->set_ = iter.set_;
+	this->id_ = iter.id_;
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator&
+CompactSet<T, FullComparer>::ConstIterator::operator=(
+	const ConstIterator& const_iter) {
+	this->set_ = const_iter.set_;
+	this->id_ = const_iter.id_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::ConstIterator::operator==(
+	const Iterator& iter) const {
+	return this->id_ == iter.id_ && this->set_ == iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::ConstIterator::operator!=(
+	const Iterator& iter) const {
+	return this->id_ != iter.id_ || this->set_ != iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::ConstIterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->id_ == const_iter.id_ && this->set_ == const_iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool CompactSet<T, FullComparer>::ConstIterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return this->id_ != const_iter.id_ || this->set_ != const_iter.set_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+const T& CompactSet<T, FullComparer>::ConstIterator::operator*() const {
+	PHI__debug_if(this->id_ == null_id) { PHI__throw("iter error"); }
+	return this->set_->nodes_[this->id_].value;
+}
+
+template<typename T, typename FullComparer>
+const T* CompactSet<T, FullComparer>::ConstIterator::operator->() const {
+	PHI__debug_if(this->id_ == null_id) { PHI__throw("iter error"); }
+	return &this->set_->nodes_[this->id_].value;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator&
+CompactSet<T, FullComparer>::ConstIterator::operator++() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+
+	this->id_ = this->id_ == null_id ? this->set_->most_l_(this->set_->root_)
+									 : this->set_->next_(this->id_);
+
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename CompactSet<T, FullComparer>::ConstIterator&
+CompactSet<T, FullComparer>::ConstIterator::operator--() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+
+	this->id_ = this->id_ == null_id ? this->set_->most_r_(this->set_->root_)
+									 : this->set_->prev_(this->id_);
+
+	return *this;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef PHI__define_guard__Container__ConcurrentSkipListMap_h
+#define PHI__define_guard__Container__ConcurrentSkipListMap_h
+
+#include "../Utility/pair.h"
+#include "../Utility/compare.h"
+#include "Map.h"
+#include "ConcurrentSkipListSet.h"
+
+namespace phi {
+namespace cntr {
+
+template<typename Index, typename Value,
+		 typename FullComparer = DefaultFullComparer>
+using ConcurrentSkipListMap =
+	ConcurrentSkipListSet<pair<Index, Value>,
+						  MapFullComparer<Index, Value, FullComparer>>;
+
+}
+}
+
+#endif
@@ -0,0 +1,589 @@
+#ifndef PHI__define_guard__Container__ConcurrentSkipListSet_h
+#define PHI__define_guard__Container__ConcurrentSkipListSet_h
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include "../Utility/memory_op.h"
+#include "../Utility/compare.h"
+
+namespace phi {
+namespace cntr {
+
+namespace concurrent_skip_list_utility {
+
+constexpr size_t max_thread_num = 256;
+
+/*
+Every thread which touches a ConcurrentSkipListSet takes a slot in
+[0, max_thread_num) on its first access, the slot is given back when the
+thread exits. At most max_thread_num threads may hold a slot at once, the
+process aborts if one more asks for a slot.
+*/
+struct ThreadSlot {
+	size_t id;
+
+	ThreadSlot();
+	~ThreadSlot();
+
+	static std::atomic<bool>* used();
+};
+
+inline std::atomic<bool>* ThreadSlot::used() {
+	static std::atomic<bool> r[max_thread_num];
+	return r;
+}
+
+inline ThreadSlot::ThreadSlot() {
+	for (size_t i(0); i != max_thread_num; ++i) {
+		if (!used()[i].load(std::memory_order_relaxed) &&
+			!used()[i].exchange(true, std::memory_order_acquire)) {
+			this->id = i;
+			return;
+		}
+	}
+
+	std::fputs("ConcurrentSkipListSet: too many threads\n", stderr);
+	std::abort();
+}
+
+inline ThreadSlot::~ThreadSlot() {
+	used()[this->id].store(false, std::memory_order_release);
+}
+
+inline size_t thread_id() {
+	thread_local ThreadSlot slot;
+	return slot.id;
+}
+
+inline size_t random_height(size_t max_height) {
+	thread_local unsigned long long int x(
+		0x9e3779b97f4a7c15ull ^ (unsigned long long int)(&x));
+
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+
+	size_t r(1);
+	for (unsigned long long int y(x); r != max_height && (y & 1); y >>= 1) {
+		++r;
+	}
+
+	return r;
+}
+
+}
+
+/*
+ConcurrentSkipListSet is a lock-free ordered set (Fraser, Herlihy & Shavit).
+Find and Contain never write shared memory besides the epoch of the calling
+thread, Insert and FindErase only use CAS. FindErase marks the links of the
+node first (logical deletion) and unlinks it afterwards, every traversal
+helps unlinking marked nodes.
+
+Unlinked nodes are reclaimed by epoch-based reclamation. The global epoch only
+advances when every thread inside an operation has announced it, so a thread
+which retires a node in epoch e and every thread which may still reach the
+node announced e + 1 at most, and the node is freed once the global epoch
+reaches e + 3.
+
+Values are copied out by Find because a node may be reclaimed as soon as the
+operation which found it returns. The destructor must not run concurrently
+with other operations.
+*/
+
+template<typename T, typename FullComparer = DefaultFullComparer>
+class ConcurrentSkipListSet {
+public:
+	static constexpr size_t max_height = 32;
+	static constexpr size_t max_thread_num =
+		concurrent_skip_list_utility::max_thread_num;
+
+	struct Node {
+		friend class ConcurrentSkipListSet;
+
+		T value;
+
+	private:
+		Node* retired_next_;
+		std::atomic<size_t> ref_;
+		size_t height_;
+		std::atomic<size_t> next_[1];
+
+		template<typename... Args>
+		Node(size_t height, Args&&... args);
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const;
+	bool empty() const;
+
+	const FullComparer& full_cmper() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	ConcurrentSkipListSet(const FullComparer& full_cmper = FullComparer());
+
+	~ConcurrentSkipListSet();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> bool Contain(const Index& index) const;
+
+	template<typename Index> bool Find(const Index& index, T& dst) const;
+
+	/*
+	 * Calls func(value) for every element in order. Elements inserted or erased
+	 * during the traversal may or may not be visited.
+	*/
+	template<typename F> void ForEach(F&& func) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename... Args> bool Insert(Args&&... args);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> bool FindErase(const Index& index);
+
+private:
+	struct alignas(64) Record_ {
+		std::atomic<size_t> state; // (epoch << 1) | active
+		size_t epoch;
+		size_t retired_num;
+		Node* limbo[4];
+	};
+
+	std::atomic<size_t> size_;
+	std::atomic<size_t> head_[max_height];
+
+	FullComparer full_cmper_;
+
+	mutable std::atomic<size_t> epoch_;
+	mutable Record_ records_[max_thread_num];
+
+	static Node* ptr_(size_t link);
+	static bool marked_(size_t link);
+
+	std::atomic<size_t>& link_(Node* node, size_t level) const;
+
+	template<typename... Args> static Node* New_(Args&&... args);
+	static void Delete_(Node* node);
+	static void DeleteAll_(Node* node);
+
+	Record_& Enter_() const;
+	void Exit_(Record_& record) const;
+	void TryAdvance_() const;
+	void Retire_(Record_& record, Node* node);
+	void Unref_(Record_& record, Node* node);
+
+	template<typename Index> Node* FindNode_(const Index& index) const;
+
+	template<typename Index>
+	bool Find_(const Index& index, Node** preds, Node** succs);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+ConcurrentSkipListSet<T, FullComparer>::Node::Node(size_t height,
+												   Args&&... args):
+	value(Forward<Args>(args)...),
+	retired_next_(nullptr), ref_(2), height_(height) {
+	for (size_t i(0); i != height; ++i) {
+		new (this->next_ + i) std::atomic<size_t>(0);
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+size_t ConcurrentSkipListSet<T, FullComparer>::size() const {
+	return this->size_.load(std::memory_order_relaxed);
+}
+
+template<typename T, typename FullComparer>
+bool ConcurrentSkipListSet<T, FullComparer>::empty() const {
+	return this->size() == 0;
+}
+
+template<typename T, typename FullComparer>
+const FullComparer& ConcurrentSkipListSet<T, FullComparer>::full_cmper() const {
+	return this->full_cmper_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+ConcurrentSkipListSet<T, FullComparer>::ConcurrentSkipListSet(
+	const FullComparer& full_cmper):
+	size_(0),
+	full_cmper_(full_cmper), epoch_(0) {
+	for (size_t i(0); i != max_height; ++i) { this->head_[i].store(0); }
+
+	for (size_t i(0); i != max_thread_num; ++i) {
+		this->records_[i].state.store(0);
+		this->records_[i].epoch = 0;
+		this->records_[i].retired_num = 0;
+		for (size_t j(0); j != 4; ++j) { this->records_[i].limbo[j] = nullptr; }
+	}
+}
+
+template<typename T, typename FullComparer>
+ConcurrentSkipListSet<T, FullComparer>::~ConcurrentSkipListSet() {
+	for (Node* node(ptr_(this->head_[0].load())); node != nullptr;) {
+		Node* next(ptr_(node->next_[0].load()));
+		Delete_(node);
+		node = next;
+	}
+
+	for (size_t i(0); i != max_thread_num; ++i) {
+		for (size_t j(0); j != 4; ++j) {
+			DeleteAll_(this->records_[i].limbo[j]);
+		}
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename ConcurrentSkipListSet<T, FullComparer>::Node*
+ConcurrentSkipListSet<T, FullComparer>::ptr_(size_t link) {
+	return reinterpret_cast<Node*>(link & ~size_t(1));
+}
+
+template<typename T, typename FullComparer>
+bool ConcurrentSkipListSet<T, FullComparer>::marked_(size_t link) {
+	return link & 1;
+}
+
+template<typename T, typename FullComparer>
+std::atomic<size_t>&
+ConcurrentSkipListSet<T, FullComparer>::link_(Node* node, size_t level) const {
+	return node == nullptr ? const_cast<std::atomic<size_t>&>(this->head_[level])
+						   : node->next_[level];
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+typename ConcurrentSkipListSet<T, FullComparer>::Node*
+ConcurrentSkipListSet<T, FullComparer>::New_(Args&&... args) {
+	size_t height(concurrent_skip_list_utility::random_height(max_height));
+
+	return new (Malloc(sizeof(Node) +
+					   (height - 1) * sizeof(std::atomic<size_t>)))
+		Node(height, Forward<Args>(args)...);
+}
+
+template<typename T, typename FullComparer>
+void ConcurrentSkipListSet<T, FullComparer>::Delete_(Node* node) {
+	node->value.~T();
+	Free(node);
+}
+
+template<typename T, typename FullComparer>
+void ConcurrentSkipListSet<T, FullComparer>::DeleteAll_(Node* node) {
+	while (node != nullptr) {
+		Node* next(node->retired_next_);
+		Delete_(node);
+		node = next;
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename ConcurrentSkipListSet<T, FullComparer>::Record_&
+ConcurrentSkipListSet<T, FullComparer>::Enter_() const {
+	Record_& record(this->records_[concurrent_skip_list_utility::thread_id()]);
+
+	size_t epoch(this->epoch_.load());
+	record.state.store((epoch << 1) | 1);
+
+	if (record.epoch != epoch) {
+		// nodes retired by this thread in epoch - 3 or before
+
+		record.epoch = epoch;
+		DeleteAll_(record.limbo[(epoch + 1) % 4]);
+		record.limbo[(epoch + 1) % 4] = nullptr;
+	}
+
+	return record;
+}
+
+template<typename T, typename FullComparer>
+void ConcurrentSkipListSet<T, FullComparer>::Exit_(Record_& record) const {
+	record.state.store(0, std::memory_order_release);
+}
+
+template<typename T, typename FullComparer>
+void ConcurrentSkipListSet<T, FullComparer>::TryAdvance_() const {
+	size_t epoch(this->epoch_.load());
+
+	for (size_t i(0); i != max_thread_num; ++i) {
+		size_t state(this->records_[i].state.load());
+		if ((state & 1) && (state >> 1) != epoch) { return; }
+	}
+
+	this->epoch_.compare_exchange_strong(epoch, epoch + 1);
+}
+
+template<typename T, typename FullComparer>
+void ConcurrentSkipListSet<T, FullComparer>::Retire_(Record_& record,
+													 Node* node) {
+	node->retired_next_ = record.limbo[record.epoch % 4];
+	record.limbo[record.epoch % 4] = node;
+
+	if (++record.retired_num % 64 == 0) { this->TryAdvance_(); }
+}
+
+/*
+ * A published node is referenced by its inserter until the inserter stops
+ * linking it, and by its eraser until the eraser has unlinked it. The last
+ * one retires the node.
+*/
+template<typename T, typename FullComparer>
+void ConcurrentSkipListSet<T, FullComparer>::Unref_(Record_& record,
+													Node* node) {
+	if (node->ref_.fetch_sub(1) == 1) { this->Retire_(record, node); }
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename ConcurrentSkipListSet<T, FullComparer>::Node*
+ConcurrentSkipListSet<T, FullComparer>::FindNode_(const Index& index) const {
+	Node* pred(nullptr);
+	Node* curr(nullptr);
+
+	for (size_t level(max_height); level-- != 0;) {
+		curr = ptr_(this->link_(pred, level).load());
+
+		while (curr != nullptr) {
+			size_t succ(curr->next_[level].load());
+
+			if (marked_(succ)) {
+				curr = ptr_(succ);
+				continue;
+			}
+
+			if (this->full_cmper_(curr->value, index) != -1) { break; }
+
+			pred = curr;
+			curr = ptr_(succ);
+		}
+	}
+
+	return curr != nullptr && !marked_(curr->next_[0].load()) &&
+				   this->full_cmper_(curr->value, index) == 0
+			   ? curr
+			   : nullptr;
+}
+
+/*
+ * Fills preds and succs with the neighbours of index on every level, where
+ * nullptr in preds stands for the head. Marked nodes on the way are unlinked.
+ * Returns whether succs[0] is equal to index.
+*/
+template<typename T, typename FullComparer>
+template<typename Index>
+bool ConcurrentSkipListSet<T, FullComparer>::Find_(const Index& index,
+												   Node** preds,
+												   Node** succs) {
+retry:;
+
+	Node* pred(nullptr);
+
+	for (size_t level(max_height); level-- != 0;) {
+		Node* curr(ptr_(this->link_(pred, level).load()));
+
+		while (curr != nullptr) {
+			size_t succ(curr->next_[level].load());
+
+			if (marked_(succ)) {
+				size_t expected(reinterpret_cast<size_t>(curr));
+
+				if (!this->link_(pred, level)
+						 .compare_exchange_strong(expected,
+												  succ & ~size_t(1))) {
+					goto retry;
+				}
+
+				curr = ptr_(succ);
+				continue;
+			}
+
+			if (this->full_cmper_(curr->value, index) != -1) { break; }
+
+			pred = curr;
+			curr = ptr_(succ);
+		}
+
+		preds[level] = pred;
+		succs[level] = curr;
+	}
+
+	return succs[0] != nullptr && this->full_cmper_(succs[0]->value, index) == 0;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool ConcurrentSkipListSet<T, FullComparer>::Contain(const Index& index) const {
+	Record_& record(this->Enter_());
+	bool r(this->FindNode_(index) != nullptr);
+	this->Exit_(record);
+	return r;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool ConcurrentSkipListSet<T, FullComparer>::Find(const Index& index,
+												  T& dst) const {
+	Record_& record(this->Enter_());
+	Node* node(this->FindNode_(index));
+	if (node != nullptr) { dst = node->value; }
+	this->Exit_(record);
+	return node != nullptr;
+}
+
+template<typename T, typename FullComparer>
+template<typename F>
+void ConcurrentSkipListSet<T, FullComparer>::ForEach(F&& func) const {
+	Record_& record(this->Enter_());
+
+	for (Node* node(ptr_(this->head_[0].load())); node != nullptr;) {
+		size_t next(node->next_[0].load());
+		if (!marked_(next)) { func(static_cast<const T&>(node->value)); }
+		node = ptr_(next);
+	}
+
+	this->Exit_(record);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+bool ConcurrentSkipListSet<T, FullComparer>::Insert(Args&&... args) {
+	Node* preds[max_height];
+	Node* succs[max_height];
+
+	Record_& record(this->Enter_());
+	Node* node(New_(Forward<Args>(args)...));
+	size_t height(node->height_);
+
+	for (;;) {
+		if (this->Find_(node->value, preds, succs)) {
+			this->Exit_(record);
+			Delete_(node);
+			return false;
+		}
+
+		for (size_t i(0); i != height; ++i) {
+			node->next_[i].store(reinterpret_cast<size_t>(succs[i]));
+		}
+
+		size_t expected(reinterpret_cast<size_t>(succs[0]));
+
+		if (this->link_(preds[0], 0).compare_exchange_strong(
+				expected, reinterpret_cast<size_t>(node))) {
+			break;
+		}
+	}
+
+	this->size_.fetch_add(1, std::memory_order_relaxed);
+
+	for (size_t level(1); level != height; ++level) {
+		for (;;) {
+			size_t next(node->next_[level].load());
+			size_t succ(reinterpret_cast<size_t>(succs[level]));
+
+			// a marked link means the node is being erased, stop linking it
+
+			if (marked_(next) ||
+				(next != succ &&
+				 !node->next_[level].compare_exchange_strong(next, succ))) {
+				goto link_complete;
+			}
+
+			if (this->link_(preds[level], level)
+					.compare_exchange_strong(succ,
+											 reinterpret_cast<size_t>(node))) {
+				break;
+			}
+
+			this->Find_(node->value, preds, succs);
+			if (succs[0] != node) { goto link_complete; }
+		}
+	}
+
+link_complete:;
+
+	if (marked_(node->next_[0].load())) {
+		this->Find_(node->value, preds, succs);
+	}
+
+	this->Unref_(record, node);
+	this->Exit_(record);
+
+	return true;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool ConcurrentSkipListSet<T, FullComparer>::FindErase(const Index& index) {
+	Node* preds[max_height];
+	Node* succs[max_height];
+
+	Record_& record(this->Enter_());
+
+	if (!this->Find_(index, preds, succs)) {
+		this->Exit_(record);
+		return false;
+	}
+
+	Node* node(succs[0]);
+
+	for (size_t level(node->height_); --level != 0;) {
+		node->next_[level].fetch_or(1);
+	}
+
+	if (marked_(node->next_[0].fetch_or(1))) {
+		// erased by another thread
+		this->Exit_(record);
+		return false;
+	}
+
+	this->size_.fetch_sub(1, std::memory_order_relaxed);
+
+	this->Find_(index, preds, succs);
+	this->Unref_(record, node);
+	this->Exit_(record);
+
+	return true;
+}
+
+}
+}
+
+#endif
@@ -30,6 +30,8 @@ struct DoublyNode {
 	inline void PushNext(DoublyNode* node);
 	inline void PushNextNew(void* node_memory);
 
+	inline void PushPrevRange(DoublyNode* first, DoublyNode* last);
+
 	inline DoublyNode* Pop();
 
 	inline void Replace(DoublyNode* node);
@@ -144,6 +146,16 @@ void DoublyNode::PushNextAllExcept(DoublyNode* node) {
 	node->prev_ = node->next_ = node;
 }
 
+/*
+ * Moves the nodes from first to last (inclusive) before this. last should be
+ * reachable from first by next() and this should not be one of them.
+*/
+void DoublyNode::PushPrevRange(DoublyNode* first, DoublyNode* last) {
+	Link_(first->prev_, last->next_);
+	Link_(this->prev_, first);
+	Link_(last, this);
+}
+
 #///////////////////////////////////////////////////////////////////////////////
 
 DoublyNode* DoublyNode::Pop() {
@@ -0,0 +1,648 @@
+#ifndef PHI__define_guard__Container__FlatSet_h
+#define PHI__define_guard__Container__FlatSet_h
+
+#include "../Utility/memory_op.h"
+#include "../Utility/pair.h"
+#include "../Utility/compare.h"
+#include "../Utility/search.h"
+#include "../Utility/sort4.h"
+#include "Vector.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+FlatSet keeps its elements sorted in a contiguous Vector. Find is a binary
+search, Insert and Erase shift the elements behind the position. Suitable for
+small or read-mostly sets, InsertIterator inserts a batch in O(k log k + n).
+
+Inserting or erasing invalidates iterators behind the position.
+*/
+
+template<typename T, typename FullComparer = DefaultFullComparer>
+class FlatSet {
+public:
+	class Iterator;
+	class ConstIterator;
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	class Iterator {
+		friend class FlatSet;
+
+	public:
+		Iterator(const Iterator& iter);
+
+		Iterator& operator=(const Iterator& iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		T& operator*() const;
+		T* operator->() const;
+
+		Iterator& operator++();
+		Iterator& operator--();
+
+	private:
+		FlatSet* set_;
+		size_t index_;
+
+		Iterator(FlatSet* set, size_t index);
+	};
+
+	class ConstIterator {
+		friend class FlatSet;
+
+	public:
+		ConstIterator(const Iterator& iter);
+		ConstIterator(const ConstIterator& const_iter);
+
+		ConstIterator& operator=(const Iterator& iter);
+		ConstIterator& operator=(const ConstIterator& const_iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		const T& operator*() const;
+		const T* operator->() const;
+
+		ConstIterator& operator++();
+		ConstIterator& operator--();
+
+	private:
+		const FlatSet* set_;
+		size_t index_;
+
+		ConstIterator(const FlatSet* set, size_t index);
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const;
+	size_t capacity() const;
+	bool empty() const;
+
+	FullComparer& full_cmper();
+	const FullComparer& full_cmper() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	Iterator first_iterator();
+	Iterator last_iterator();
+	Iterator null_iterator();
+
+	ConstIterator first_iterator() const;
+	ConstIterator last_iterator() const;
+	ConstIterator null_iterator() const;
+
+	ConstIterator first_const_iterator() const;
+	ConstIterator last_const_iterator() const;
+	ConstIterator null_const_iterator() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	FlatSet(const FullComparer& full_cmper = FullComparer());
+	FlatSet(const FlatSet& set);
+	FlatSet(FlatSet&& set);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	FlatSet& operator=(const FlatSet& set);
+	FlatSet& operator=(FlatSet&& set);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool operator==(const FlatSet& set) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	const T& operator[](size_t index) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> bool Contain(const Index& index) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> Iterator Find(const Index& index);
+	template<typename Index> ConstIterator Find(const Index& index) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename... Args> pair<Iterator, bool> Insert(Args&&... args);
+
+	template<typename ForwardIterator>
+	size_t InsertIterator(ForwardIterator begin, ForwardIterator end);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	Iterator Erase(const Iterator& iter);
+	template<typename Index> bool FindErase(const Index& index);
+
+	void Clear();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	void Reserve(size_t capacity);
+
+private:
+	Vector<T> data_;
+	FullComparer full_cmper_;
+
+	template<typename Index> size_t Find_(const Index& index) const;
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+size_t FlatSet<T, FullComparer>::size() const {
+	return this->data_.size();
+}
+
+template<typename T, typename FullComparer>
+size_t FlatSet<T, FullComparer>::capacity() const {
+	return this->data_.capacity();
+}
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::empty() const {
+	return this->data_.empty();
+}
+
+template<typename T, typename FullComparer>
+FullComparer& FlatSet<T, FullComparer>::full_cmper() {
+	return this->full_cmper_;
+}
+
+template<typename T, typename FullComparer>
+const FullComparer& FlatSet<T, FullComparer>::full_cmper() const {
+	return this->full_cmper_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::Iterator
+FlatSet<T, FullComparer>::first_iterator() {
+	return Iterator(this, 0);
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::Iterator
+FlatSet<T, FullComparer>::last_iterator() {
+	return Iterator(this, this->empty() ? 0 : this->size() - 1);
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::Iterator
+FlatSet<T, FullComparer>::null_iterator() {
+	return Iterator(this, this->size());
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator
+FlatSet<T, FullComparer>::first_iterator() const {
+	return ConstIterator(this, 0);
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator
+FlatSet<T, FullComparer>::last_iterator() const {
+	return ConstIterator(this, this->empty() ? 0 : this->size() - 1);
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator
+FlatSet<T, FullComparer>::null_iterator() const {
+	return ConstIterator(this, this->size());
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator
+FlatSet<T, FullComparer>::first_const_iterator() const {
+	return ConstIterator(this, 0);
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator
+FlatSet<T, FullComparer>::last_const_iterator() const {
+	return ConstIterator(this, this->empty() ? 0 : this->size() - 1);
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator
+FlatSet<T, FullComparer>::null_const_iterator() const {
+	return ConstIterator(this, this->size());
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::FlatSet(const FullComparer& full_cmper):
+	full_cmper_(full_cmper) {}
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::FlatSet(const FlatSet& set):
+	data_(set.data_), full_cmper_(set.full_cmper_) {}
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::FlatSet(FlatSet&& set):
+	data_(Move(set.data_)), full_cmper_(Move(set.full_cmper_)) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>&
+FlatSet<T, FullComparer>::operator=(const FlatSet& set) {
+	this->data_ = set.data_;
+	this->full_cmper_ = set.full_cmper_;
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>& FlatSet<T, FullComparer>::operator=(FlatSet&& set) {
+	this->data_ = Move(set.data_);
+	this->full_cmper_ = Move(set.full_cmper_);
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::operator==(const FlatSet& set) const {
+	if (this == &set) { return true; }
+	if (this->size() != set.size()) { return false; }
+
+	for (size_t i(0); i != this->size(); ++i) {
+		if (this->full_cmper_(this->data_[i], set.data_[i]) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+const T& FlatSet<T, FullComparer>::operator[](size_t index) const {
+	PHI__debug_if(this->size() <= index) { PHI__throw("index error"); }
+	return this->data_[index];
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename Index>
+size_t FlatSet<T, FullComparer>::Find_(const Index& index) const {
+	const T* begin(this->data_.data());
+	return BinarySearch(begin, begin + this->size(), index,
+						this->full_cmper_) -
+		   begin;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool FlatSet<T, FullComparer>::Contain(const Index& index) const {
+	return this->Find_(index) != this->size();
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename FlatSet<T, FullComparer>::Iterator
+FlatSet<T, FullComparer>::Find(const Index& index) {
+	return Iterator(this, this->Find_(index));
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename FlatSet<T, FullComparer>::ConstIterator
+FlatSet<T, FullComparer>::Find(const Index& index) const {
+	return ConstIterator(this, this->Find_(index));
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+pair<typename FlatSet<T, FullComparer>::Iterator, bool>
+FlatSet<T, FullComparer>::Insert(Args&&... args) {
+	const FullComparer& full_cmper(this->full_cmper_);
+	T value(Forward<Args>(args)...);
+
+	T* begin(this->data_.data());
+	T* end(begin + this->size());
+	size_t i(LowerBound(begin, end, value, full_cmper) - begin);
+
+	if (begin + i != end && full_cmper(value, begin[i]) == 0) {
+		return pair<Iterator, bool>(Iterator(this, i), false);
+	}
+
+	this->data_.Insert(i, Move(value));
+	return pair<Iterator, bool>(Iterator(this, i), true);
+}
+
+/*
+ * Inserts the elements in [begin, end) which are not in this set yet.
+ * The new elements are appended, sorted and deduplicated, then merged with the
+ * old ones if their ranges overlap.
+ * Returns the number of inserted elements.
+*/
+template<typename T, typename FullComparer>
+template<typename ForwardIterator>
+size_t FlatSet<T, FullComparer>::InsertIterator(ForwardIterator begin,
+												ForwardIterator end) {
+	const FullComparer& full_cmper(this->full_cmper_);
+	size_t old_size(this->size());
+
+	for (; begin != end; ++begin) { this->data_.Push(*begin); }
+
+	T* old_begin(this->data_.data());
+	T* old_end(old_begin + old_size);
+	T* new_end(old_begin + this->size());
+
+	Sort(old_end, new_end, full_cmper);
+
+	T* j(old_end);
+
+	for (T* i(old_end); i != new_end; ++i) {
+		if (j != old_end && full_cmper(*(j - 1), *i) == 0) { continue; }
+
+		if (BinarySearch(old_begin, old_end, *i, full_cmper) != old_end) {
+			continue;
+		}
+
+		if (i != j) { *j = Move(*i); }
+		++j;
+	}
+
+	size_t inserted_size(j - old_end);
+	this->data_.Pop(this->size() - old_size - inserted_size);
+
+	if (old_size == 0 || inserted_size == 0 ||
+		full_cmper(*(old_end - 1), *old_end) == -1) {
+		return inserted_size;
+	}
+
+	Vector<T> data;
+	data.Reserve(this->size());
+
+	T* x(old_begin);
+	T* y(old_end);
+
+	while (x != old_end && y != j) {
+		if (full_cmper(*y, *x) == -1) {
+			data.Push(Move(*y));
+			++y;
+		} else {
+			data.Push(Move(*x));
+			++x;
+		}
+	}
+
+	for (; x != old_end; ++x) { data.Push(Move(*x)); }
+	for (; y != j; ++y) { data.Push(Move(*y)); }
+
+	this->data_ = Move(data);
+
+	return inserted_size;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::Iterator
+FlatSet<T, FullComparer>::Erase(const Iterator& iter) {
+	PHI__debug_if(this != iter.set_) { PHI__throw("iter error"); }
+	if (iter.index_ < this->size()) { this->data_.Erase(iter.index_); }
+	return iter;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool FlatSet<T, FullComparer>::FindErase(const Index& index) {
+	size_t i(this->Find_(index));
+	if (i == this->size()) { return false; }
+	this->data_.Erase(i);
+	return true;
+}
+
+template<typename T, typename FullComparer>
+void FlatSet<T, FullComparer>::Clear() {
+	this->data_.Clear();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+void FlatSet<T, FullComparer>::Reserve(size_t capacity) {
+	this->data_.Reserve(capacity);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::Iterator::Iterator(const Iterator& iter):
+	set_(iter.set_), index_(iter.index_) {}
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::Iterator::Iterator(FlatSet* set, size_t index):
+	set_(set), index_(index) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::Iterator&
+FlatSet<T, FullComparer>::Iterator::operator=(const Iterator& iter) {
+	this->set_ = iter.set_;
+	this->index_ = iter.index_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::Iterator::operator==(
+	const Iterator& iter) const {
+	return this->index_ == iter.index_ && this->set_ == iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::Iterator::operator!=(
+	const Iterator& iter) const {
+	return this->index_ != iter.index_ || this->set_ != iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::Iterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->index_ == const_iter.index_ && this->set_ == const_iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::Iterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return this->index_ != const_iter.index_ || this->set_ != const_iter.set_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+T& FlatSet<T, FullComparer>::Iterator::operator*() const {
+	PHI__debug_if(this->set_->size() <= this->index_) {
+		PHI__throw("iter error");
+	}
+
+	return this->set_->data_[this->index_];
+}
+
+template<typename T, typename FullComparer>
+T* FlatSet<T, FullComparer>::Iterator::operator->() const {
+	PHI__debug_if(this->set_->size() <= this->index_) {
+		PHI__throw("iter error");
+	}
+
+	return &this->set_->data_[this->index_];
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::Iterator&
+FlatSet<T, FullComparer>::Iterator::operator++() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+	this->index_ = this->index_ == this->set_->size() ? 0 : this->index_ + 1;
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::Iterator&
+FlatSet<T, FullComparer>::Iterator::operator--() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+	this->index_ = this->index_ == 0 ? this->set_->size() : this->index_ - 1;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::ConstIterator::ConstIterator(const Iterator& iter):
+	set_(iter.set_), index_(iter.index_) {}
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::ConstIterator::ConstIterator(
+	const ConstIterator& const_iter):
+	set_(const_iter.set_),
+	index_(const_iter.index_) {}
+
+template<typename T, typename FullComparer>
+FlatSet<T, FullComparer>::ConstIterator::ConstIterator(const FlatSet* set,
+													   size_t index):
+	set_(set),
+	index_(index) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator&
+FlatSet<T, FullComparer>::ConstIterator::operator=(const Iterator& iter) {
+	this->set_ = iter.set_;
+	this->index_ = iter.index_;
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator&
+FlatSet<T, FullComparer>::ConstIterator::operator=(
+	const ConstIterator& const_iter) {
+	this->set_ = const_iter.set_;
+	this->index_ = const_iter.index_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::ConstIterator::operator==(
+	const Iterator& iter) const {
+	return this->index_ == iter.index_ && this->set_ == iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::ConstIterator::operator!=(
+	const Iterator& iter) const {
+	return this->index_ != iter.index_ || this->set_ != iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::ConstIterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->index_ == const_iter.index_ && this->set_ == const_iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool FlatSet<T, FullComparer>::ConstIterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return this->index_ != const_iter.index_ || this->set_ != const_iter.set_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+const T& FlatSet<T, FullComparer>::ConstIterator::operator*() const {
+	PHI__debug_if(this->set_->size() <= this->index_) {
+		PHI__throw("iter error");
+	}
+
+	return this->set_->data_[this->index_];
+}
+
+template<typename T, typename FullComparer>
+const T* FlatSet<T, FullComparer>::ConstIterator::operator->() const {
+	PHI__debug_if(this->set_->size() <= this->index_) {
+		PHI__throw("iter error");
+	}
+
+	return &this->set_->data_[this->index_];
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator&
+FlatSet<T, FullComparer>::ConstIterator::operator++() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+	this->index_ = this->index_ == this->set_->size() ? 0 : this->index_ + 1;
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename FlatSet<T, FullComparer>::ConstIterator&
+FlatSet<T, FullComparer>::ConstIterator::operator--() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+	this->index_ = this->index_ == 0 ? this->set_->size() : this->index_ - 1;
+	return *this;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,419 @@
+#ifndef PHI__define_guard__Container__IndexedPriorityQueue_h
+#define PHI__define_guard__Container__IndexedPriorityQueue_h
+
+#include "../Utility/memory_op.h"
+#include "../Utility/compare.h"
+#include "Vector.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+IndexedPriorityQueue is a D-ary heap whose elements can be reached after
+pushing, top() is the greatest element by LessThanComparer like
+PriorityQueue. Push returns a Handle that stays valid, whatever is pushed or
+popped after, until its element leaves the queue. Through it the element can
+be read, erased or given a new value in O(D log_D n).
+
+IncreaseKey takes a value not less than the current one and moves it toward
+the top, DecreaseKey one not greater and moves it away, Update either. With a
+greater-than comparer, as for Dijkstra and A*, the least is on top and
+shortening a distance is an IncreaseKey.
+
+The heap holds each element next to its Handle and a table indexed by Handle
+holds the position of each element in the heap, so a comparison reads no
+more than the heap. Handles of elements gone are reused.
+*/
+
+template<typename T, typename LessThanComparer = DefaultLessThanComparer,
+		 size_t D = 4>
+class IndexedPriorityQueue {
+public:
+	static_assert(2 <= D, "D error");
+
+	using Handle = size_t;
+
+	size_t size() const;
+	bool empty() const;
+
+	const T& top() const;
+	Handle top_handle() const;
+
+	const T& value(Handle handle) const;
+
+	bool Contain(Handle handle) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IndexedPriorityQueue(const LessThanComparer& lt_cmper = LessThanComparer());
+	IndexedPriorityQueue(const IndexedPriorityQueue& ipq) = delete;
+
+	~IndexedPriorityQueue();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IndexedPriorityQueue& operator=(const IndexedPriorityQueue& ipq) = delete;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename... Args> Handle Push(Args&&... args);
+
+	void Pop();
+	void Pop(T& dst);
+
+	void Erase(Handle handle);
+
+	template<typename Value> void IncreaseKey(Handle handle, Value&& value);
+	template<typename Value> void DecreaseKey(Handle handle, Value&& value);
+	template<typename Value> void Update(Handle handle, Value&& value);
+
+	void Clear();
+
+	void Reserve(size_t capacity);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool IsHeap() const;
+
+private:
+	struct Entry_ {
+		T value;
+		Handle handle;
+
+		template<typename... Args>
+		Entry_(Handle handle, Args&&... args):
+			value(Forward<Args>(args)...), handle(handle) {}
+	};
+
+	size_t size_;
+	size_t capacity_;
+
+	Entry_* heap_;
+
+	// the position in heap_ of each Handle, npos if free
+	Vector<size_t> pos_;
+	Vector<Handle> free_handles_;
+
+	LessThanComparer lt_cmper_;
+
+	static constexpr size_t npos_ = ~size_t(0);
+
+	size_t GreatestChild_(size_t c) const;
+
+	void Place_(size_t pos, Entry_& entry);
+
+	void SiftUp_(size_t hole, Entry_& entry);
+	void SiftDown_(size_t hole, Entry_& entry);
+
+	void Remove_(size_t pos);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__indexed_priority_queue_min_capacity (16)
+
+template<typename T, typename LessThanComparer, size_t D>
+size_t IndexedPriorityQueue<T, LessThanComparer, D>::size() const {
+	return this->size_;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+bool IndexedPriorityQueue<T, LessThanComparer, D>::empty() const {
+	return this->size_ == 0;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+const T& IndexedPriorityQueue<T, LessThanComparer, D>::top() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("empty"); }
+	return this->heap_[0].value;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+typename IndexedPriorityQueue<T, LessThanComparer, D>::Handle
+IndexedPriorityQueue<T, LessThanComparer, D>::top_handle() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("empty"); }
+	return this->heap_[0].handle;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+const T&
+IndexedPriorityQueue<T, LessThanComparer, D>::value(Handle handle) const {
+	PHI__debug_if(!this->Contain(handle)) { PHI__throw("handle error"); }
+	return this->heap_[this->pos_[handle]].value;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+bool IndexedPriorityQueue<T, LessThanComparer, D>::Contain(
+	Handle handle) const {
+	return handle < this->pos_.size() && this->pos_[handle] != npos_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename LessThanComparer, size_t D>
+IndexedPriorityQueue<T, LessThanComparer, D>::IndexedPriorityQueue(
+	const LessThanComparer& lt_cmper):
+	size_(0),
+	capacity_(0), heap_(nullptr), lt_cmper_(lt_cmper) {}
+
+template<typename T, typename LessThanComparer, size_t D>
+IndexedPriorityQueue<T, LessThanComparer, D>::~IndexedPriorityQueue() {
+	Delete(this->size_, this->heap_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Reserve(size_t capacity) {
+	if (capacity <= this->capacity_) { return; }
+
+	Entry_* heap(Malloc<Entry_>(capacity));
+
+	for (size_t i(0); i != this->size_; ++i) {
+		new (heap + i) Entry_(Move(this->heap_[i]));
+		this->heap_[i].~Entry_();
+	}
+
+	Free(this->heap_);
+
+	this->capacity_ = capacity;
+	this->heap_ = heap;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Clear() {
+	for (size_t i(0); i != this->size_; ++i) { this->heap_[i].~Entry_(); }
+
+	this->size_ = 0;
+	this->pos_.Clear();
+	this->free_handles_.Clear();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Returns the index of the greatest of the children starting at c, which
+ * should be less than size_.
+*/
+template<typename T, typename LessThanComparer, size_t D>
+size_t
+IndexedPriorityQueue<T, LessThanComparer, D>::GreatestChild_(size_t c) const {
+	const Entry_* heap(this->heap_);
+	size_t end(this->size_ < c + D ? this->size_ : c + D);
+	size_t r(c);
+
+	// a branch, not a mask, so the loads of the next level can start early,
+	// see PriorityQueue
+	for (size_t i(c + 1); i < end; ++i) {
+		if (this->lt_cmper_.lt(heap[r].value, heap[i].value)) { r = i; }
+	}
+
+	return r;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Place_(size_t pos,
+														  Entry_& entry) {
+	this->heap_[pos] = Move(entry);
+	this->pos_[this->heap_[pos].handle] = pos;
+}
+
+/*
+ * Moves the parents of hole down while they are less than entry and puts
+ * entry into the hole left.
+*/
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::SiftUp_(size_t hole,
+														   Entry_& entry) {
+	while (hole != 0) {
+		size_t p((hole - 1) / D);
+		if (!this->lt_cmper_.lt(this->heap_[p].value, entry.value)) { break; }
+		this->Place_(hole, this->heap_[p]);
+		hole = p;
+	}
+
+	this->Place_(hole, entry);
+}
+
+/*
+ * Moves the greatest children of hole up while entry is less than them and
+ * puts entry into the hole left.
+*/
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::SiftDown_(size_t hole,
+															 Entry_& entry) {
+	for (;;) {
+		size_t c(D * hole + 1);
+		if (this->size_ <= c) { break; }
+
+		size_t target(this->GreatestChild_(c));
+
+		if (!this->lt_cmper_.lt(entry.value, this->heap_[target].value)) {
+			break;
+		}
+
+		this->Place_(hole, this->heap_[target]);
+		hole = target;
+	}
+
+	this->Place_(hole, entry);
+}
+
+/*
+ * Frees the handle of the element at pos and fills the hole with the last
+ * element.
+*/
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Remove_(size_t pos) {
+	Handle handle(this->heap_[pos].handle);
+	this->pos_[handle] = npos_;
+	this->free_handles_.Push(handle);
+
+	size_t last(--this->size_);
+
+	if (pos == last) {
+		this->heap_[last].~Entry_();
+		return;
+	}
+
+	Entry_ entry(Move(this->heap_[last]));
+	this->heap_[last].~Entry_();
+
+	if (pos != 0 && this->lt_cmper_.lt(this->heap_[(pos - 1) / D].value,
+									   entry.value)) {
+		this->SiftUp_(pos, entry);
+	} else {
+		this->SiftDown_(pos, entry);
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename LessThanComparer, size_t D>
+template<typename... Args>
+typename IndexedPriorityQueue<T, LessThanComparer, D>::Handle
+IndexedPriorityQueue<T, LessThanComparer, D>::Push(Args&&... args) {
+	if (this->size_ == this->capacity_) {
+		this->Reserve(this->capacity_ < PHI__indexed_priority_queue_min_capacity
+						  ? PHI__indexed_priority_queue_min_capacity
+						  : this->capacity_ * 2);
+	}
+
+	Handle handle;
+
+	if (this->free_handles_.empty()) {
+		handle = this->pos_.size();
+		this->pos_.Push(npos_);
+	} else {
+		handle = this->free_handles_.back();
+		this->free_handles_.Pop();
+	}
+
+	size_t hole(this->size_++);
+	new (this->heap_ + hole) Entry_(handle, Forward<Args>(args)...);
+
+	Entry_ entry(Move(this->heap_[hole]));
+	this->SiftUp_(hole, entry);
+
+	return handle;
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Pop() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("empty"); }
+	this->Remove_(0);
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Pop(T& dst) {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("empty"); }
+	dst = Move(this->heap_[0].value);
+	this->Remove_(0);
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Erase(Handle handle) {
+	PHI__debug_if(!this->Contain(handle)) { PHI__throw("handle error"); }
+	this->Remove_(this->pos_[handle]);
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+template<typename Value>
+void IndexedPriorityQueue<T, LessThanComparer, D>::IncreaseKey(Handle handle,
+															   Value&& value) {
+	PHI__debug_if(!this->Contain(handle)) { PHI__throw("handle error"); }
+
+	size_t pos(this->pos_[handle]);
+
+	PHI__debug_if(this->lt_cmper_.lt(value, this->heap_[pos].value)) {
+		PHI__throw("value error");
+	}
+
+	Entry_ entry(Move(this->heap_[pos]));
+	entry.value = Forward<Value>(value);
+	this->SiftUp_(pos, entry);
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+template<typename Value>
+void IndexedPriorityQueue<T, LessThanComparer, D>::DecreaseKey(Handle handle,
+															   Value&& value) {
+	PHI__debug_if(!this->Contain(handle)) { PHI__throw("handle error"); }
+
+	size_t pos(this->pos_[handle]);
+
+	PHI__debug_if(this->lt_cmper_.lt(this->heap_[pos].value, value)) {
+		PHI__throw("value error");
+	}
+
+	Entry_ entry(Move(this->heap_[pos]));
+	entry.value = Forward<Value>(value);
+	this->SiftDown_(pos, entry);
+}
+
+template<typename T, typename LessThanComparer, size_t D>
+template<typename Value>
+void IndexedPriorityQueue<T, LessThanComparer, D>::Update(Handle handle,
+														  Value&& value) {
+	PHI__debug_if(!this->Contain(handle)) { PHI__throw("handle error"); }
+
+	size_t pos(this->pos_[handle]);
+
+	Entry_ entry(Move(this->heap_[pos]));
+	entry.value = Forward<Value>(value);
+
+	if (pos != 0 && this->lt_cmper_.lt(this->heap_[(pos - 1) / D].value,
+									   entry.value)) {
+		this->SiftUp_(pos, entry);
+	} else {
+		this->SiftDown_(pos, entry);
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename LessThanComparer, size_t D>
+bool IndexedPriorityQueue<T, LessThanComparer, D>::IsHeap() const {
+	for (size_t i(0); i != this->size_; ++i) {
+		if (this->pos_[this->heap_[i].handle] != i) { return false; }
+
+		if (i != 0 && this->lt_cmper_.lt(this->heap_[(i - 1) / D].value,
+										 this->heap_[i].value)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#undef PHI__indexed_priority_queue_min_capacity
+
+}
+}
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef PHI__define_guard__Container__IntrusiveHashTable_h
+#define PHI__define_guard__Container__IntrusiveHashTable_h
+
+#include "../Utility/memory_op.h"
+#include "../Utility/compare.h"
+#include "ChainingHashTable.h"
+#include "IntrusiveList.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+IntrusiveHashTable chains objects through a DoublyNode member hook, T::*hook,
+like IntrusiveList. Only the bucket array is allocated, linking and unlinking
+an object never allocates. The bucket size is kept a prime above twice the
+size, Restruct rehashes every object with hasher.
+
+hasher(key) and eq_cmper.eq(value, key) should accept both T and the key
+types passed to Contain, Find and FindRelease.
+*/
+
+template<typename T, DoublyNode T::*hook, typename Hasher = DefaultHasher,
+		 typename EqualComparer = DefaultEqualComparer>
+class IntrusiveHashTable {
+public:
+	size_t size() const;
+	bool empty() const;
+
+	size_t bucket_size() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IntrusiveHashTable(const Hasher& hasher = Hasher(),
+					   const EqualComparer& eq_cmper = EqualComparer());
+
+	IntrusiveHashTable(const IntrusiveHashTable& iht) = delete;
+	IntrusiveHashTable(IntrusiveHashTable&& iht);
+
+	~IntrusiveHashTable();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IntrusiveHashTable& operator=(const IntrusiveHashTable& iht) = delete;
+	IntrusiveHashTable& operator=(IntrusiveHashTable&& iht);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Key> bool Contain(const Key& key) const;
+
+	template<typename Key> T* Find(const Key& key);
+	template<typename Key> const T* Find(const Key& key) const;
+
+	template<typename Func> void ForEach(Func&& func);
+	template<typename Func> void ForEach(Func&& func) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool Insert(T& value);
+
+	void Reserve(size_t size);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	void Release(T& value);
+	template<typename Key> T* FindRelease(const Key& key);
+
+	void ReleaseAll();
+
+private:
+	size_t size_;
+	size_t bucket_size_;
+	DoublyNode* bucket_;
+
+	Hasher hasher_;
+	EqualComparer eq_cmper_;
+
+	static T* owner_(DoublyNode* node);
+
+	template<typename Key> DoublyNode* bucket_node_(const Key& key) const;
+
+	template<typename Key> T* Find_(const Key& key) const;
+
+	void Restruct_(size_t bucket_size);
+
+	static size_t BucketSizeShouldSet_(size_t size);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+size_t IntrusiveHashTable<T, hook, Hasher, EqualComparer>::size() const {
+	return this->size_;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+bool IntrusiveHashTable<T, hook, Hasher, EqualComparer>::empty() const {
+	return this->size_ == 0;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+size_t IntrusiveHashTable<T, hook, Hasher, EqualComparer>::bucket_size() const {
+	return this->bucket_size_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+IntrusiveHashTable<T, hook, Hasher, EqualComparer>::IntrusiveHashTable(
+	const Hasher& hasher, const EqualComparer& eq_cmper):
+	size_(0),
+	bucket_size_(0), bucket_(nullptr), hasher_(hasher), eq_cmper_(eq_cmper) {}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+IntrusiveHashTable<T, hook, Hasher, EqualComparer>::IntrusiveHashTable(
+	IntrusiveHashTable&& iht):
+	size_(iht.size_),
+	bucket_size_(iht.bucket_size_), bucket_(iht.bucket_),
+	hasher_(iht.hasher_), eq_cmper_(iht.eq_cmper_) {
+	iht.size_ = 0;
+	iht.bucket_size_ = 0;
+	iht.bucket_ = nullptr;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+IntrusiveHashTable<T, hook, Hasher, EqualComparer>::~IntrusiveHashTable() {
+	this->ReleaseAll();
+	Delete(this->bucket_size_, this->bucket_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+IntrusiveHashTable<T, hook, Hasher, EqualComparer>&
+IntrusiveHashTable<T, hook, Hasher, EqualComparer>::operator=(
+	IntrusiveHashTable&& iht) {
+	if (this == &iht) { return *this; }
+
+	this->ReleaseAll();
+	Delete(this->bucket_size_, this->bucket_);
+
+	this->size_ = iht.size_;
+	this->bucket_size_ = iht.bucket_size_;
+	this->bucket_ = iht.bucket_;
+	this->hasher_ = iht.hasher_;
+	this->eq_cmper_ = iht.eq_cmper_;
+
+	iht.size_ = 0;
+	iht.bucket_size_ = 0;
+	iht.bucket_ = nullptr;
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+T* IntrusiveHashTable<T, hook, Hasher, EqualComparer>::owner_(
+	DoublyNode* node) {
+	return intrusive_utility::owner<T, hook>(node);
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Key>
+DoublyNode* IntrusiveHashTable<T, hook, Hasher, EqualComparer>::bucket_node_(
+	const Key& key) const {
+	return this->bucket_ + size_t(this->hasher_(key)) % this->bucket_size_;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Key>
+T* IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Find_(
+	const Key& key) const {
+	if (this->size_ == 0) { return nullptr; }
+
+	DoublyNode* bucket_node(this->bucket_node_(key));
+
+	for (DoublyNode* i(bucket_node->next()); i != bucket_node; i = i->next()) {
+		if (this->eq_cmper_.eq(*owner_(i), key)) { return owner_(i); }
+	}
+
+	return nullptr;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+void IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Restruct_(
+	size_t bucket_size) {
+	DoublyNode* bucket(Malloc<DoublyNode>(bucket_size));
+
+	for (size_t i(0); i != bucket_size; ++i) { new (bucket + i) DoublyNode(); }
+
+	for (size_t i(0); i != this->bucket_size_; ++i) {
+		DoublyNode* bucket_node(this->bucket_ + i);
+
+		while (!bucket_node->sole()) {
+			DoublyNode* node(bucket_node->next());
+			bucket[size_t(this->hasher_(*owner_(node))) % bucket_size]
+				.PushPrev(node);
+		}
+	}
+
+	Delete(this->bucket_size_, this->bucket_);
+
+	this->bucket_size_ = bucket_size;
+	this->bucket_ = bucket;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+size_t
+IntrusiveHashTable<T, hook, Hasher, EqualComparer>::BucketSizeShouldSet_(
+	size_t size) {
+	size_t r(size * 2 + 1); // r must be odd
+	while (!is_prime(r)) { r += 2; }
+	return r;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Key>
+bool IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Contain(
+	const Key& key) const {
+	return this->Find_(key) != nullptr;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Key>
+T* IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Find(const Key& key) {
+	return this->Find_(key);
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Key>
+const T*
+IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Find(const Key& key) const {
+	return this->Find_(key);
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Func>
+void IntrusiveHashTable<T, hook, Hasher, EqualComparer>::ForEach(Func&& func) {
+	for (size_t i(0); i != this->bucket_size_; ++i) {
+		DoublyNode* bucket_node(this->bucket_ + i);
+
+		for (DoublyNode* j(bucket_node->next()); j != bucket_node;
+			 j = j->next()) {
+			func(*owner_(j));
+		}
+	}
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Func>
+void IntrusiveHashTable<T, hook, Hasher, EqualComparer>::ForEach(
+	Func&& func) const {
+	for (size_t i(0); i != this->bucket_size_; ++i) {
+		DoublyNode* bucket_node(this->bucket_ + i);
+
+		for (DoublyNode* j(bucket_node->next()); j != bucket_node;
+			 j = j->next()) {
+			func(static_cast<const T&>(*owner_(j)));
+		}
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Links value if no equal object is in the table. Returns whether value is
+ * linked.
+*/
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+bool IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Insert(T& value) {
+	PHI__debug_if(!(value.*hook).sole()) { PHI__throw("node error"); }
+
+	if (this->Find_(value) != nullptr) { return false; }
+
+	// doubles the bucket so that rehashing is amortized O(1) per insert
+	if (this->bucket_size_ <= this->size_ * 2) {
+		this->Restruct_(BucketSizeShouldSet_(this->size_ * 2));
+	}
+
+	++this->size_;
+	this->bucket_node_(value)->PushPrev(&(value.*hook));
+
+	return true;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+void IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Reserve(size_t size) {
+	if (size * 2 < this->bucket_size_) { return; }
+	this->Restruct_(BucketSizeShouldSet_(size));
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Unlinks value, which should be in this table. O(1).
+*/
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+void IntrusiveHashTable<T, hook, Hasher, EqualComparer>::Release(T& value) {
+	PHI__debug_if((value.*hook).sole()) { PHI__throw("node error"); }
+	--this->size_;
+	(value.*hook).Pop();
+}
+
+/*
+ * Unlinks and returns the object equal to key, or nullptr if there is none.
+*/
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+template<typename Key>
+T* IntrusiveHashTable<T, hook, Hasher, EqualComparer>::FindRelease(
+	const Key& key) {
+	T* r(this->Find_(key));
+	if (r != nullptr) { this->Release(*r); }
+	return r;
+}
+
+template<typename T, DoublyNode T::*hook, typename Hasher,
+		 typename EqualComparer>
+void IntrusiveHashTable<T, hook, Hasher, EqualComparer>::ReleaseAll() {
+	this->size_ = 0;
+
+	for (size_t i(0); i != this->bucket_size_; ++i) {
+		DoublyNode* bucket_node(this->bucket_ + i);
+		while (!bucket_node->sole()) { bucket_node->next()->Pop(); }
+	}
+}
+
+}
+}
+
+#endif
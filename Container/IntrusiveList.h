@@ -0,0 +1,599 @@
+#ifndef PHI__define_guard__Container__IntrusiveList_h
+#define PHI__define_guard__Container__IntrusiveList_h
+
+#include "DoublyNode.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+IntrusiveList links objects through a DoublyNode member hook, T::*hook, which
+the caller embeds in T. The list never allocates, copies or destroys the
+objects, it only links and unlinks their hooks. An object with several hooks
+can be in several intrusive containers at the same time.
+
+A hook is in at most one container at a time. Release an object before
+destroying it, DoublyNode unlinks itself on destruction but the size of the
+container would be wrong.
+*/
+
+namespace intrusive_utility {
+
+template<typename T, DoublyNode T::*hook> size_t hook_offset() {
+	return PHI__ptr_addr(&(static_cast<T*>(nullptr)->*hook));
+}
+
+template<typename T, DoublyNode T::*hook> T* owner(DoublyNode* node) {
+	return reinterpret_cast<T*>(PHI__ptr_addr(node) - hook_offset<T, hook>());
+}
+
+template<typename T, DoublyNode T::*hook>
+const T* owner(const DoublyNode* node) {
+	return reinterpret_cast<const T*>(PHI__ptr_addr(node) -
+									  hook_offset<T, hook>());
+}
+
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook> class IntrusiveList {
+public:
+	class Iterator;
+	class ConstIterator;
+
+	class Iterator {
+		friend class IntrusiveList;
+
+	public:
+		Iterator(const Iterator& iter);
+
+		Iterator& operator=(const Iterator& iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		T& operator*() const;
+		T* operator->() const;
+
+		Iterator& operator++();
+		Iterator& operator--();
+
+	private:
+		IntrusiveList* list_;
+		DoublyNode* node_;
+
+		Iterator(IntrusiveList* list, DoublyNode* node);
+	};
+
+	class ConstIterator {
+		friend class IntrusiveList;
+
+	public:
+		ConstIterator(const Iterator& iter);
+		ConstIterator(const ConstIterator& const_iter);
+
+		ConstIterator& operator=(const Iterator& iter);
+		ConstIterator& operator=(const ConstIterator& const_iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		const T& operator*() const;
+		const T* operator->() const;
+
+		ConstIterator& operator++();
+		ConstIterator& operator--();
+
+	private:
+		const IntrusiveList* list_;
+		const DoublyNode* node_;
+
+		ConstIterator(const IntrusiveList* list, const DoublyNode* node);
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const;
+	bool empty() const;
+
+	Iterator first_iterator();
+	Iterator last_iterator();
+	Iterator null_iterator();
+
+	ConstIterator first_iterator() const;
+	ConstIterator last_iterator() const;
+	ConstIterator null_iterator() const;
+
+	ConstIterator first_const_iterator() const;
+	ConstIterator last_const_iterator() const;
+	ConstIterator null_const_iterator() const;
+
+	Iterator iterator(T& value);
+	ConstIterator iterator(const T& value) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IntrusiveList();
+	IntrusiveList(const IntrusiveList& list) = delete;
+	IntrusiveList(IntrusiveList&& list);
+
+	~IntrusiveList();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IntrusiveList& operator=(const IntrusiveList& list) = delete;
+	IntrusiveList& operator=(IntrusiveList&& list);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	T& front();
+	const T& front() const;
+
+	T& back();
+	const T& back() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IntrusiveList& PushFront(T& value);
+	IntrusiveList& PushBack(T& value);
+	IntrusiveList& Insert(const Iterator& iter, T& value);
+
+	IntrusiveList& PushListFront(IntrusiveList& list);
+	IntrusiveList& PushListBack(IntrusiveList& list);
+
+	IntrusiveList& MoveToFront(T& value);
+	IntrusiveList& MoveToBack(T& value);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IntrusiveList& PopFront();
+	IntrusiveList& PopBack();
+	IntrusiveList& Pop(const Iterator& iter);
+
+	IntrusiveList& Release(T& value);
+	void ReleaseAll();
+
+private:
+	size_t size_;
+	DoublyNode node_;
+
+	static T* owner_(DoublyNode* node);
+	static const T* owner_(const DoublyNode* node);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+T* IntrusiveList<T, hook>::owner_(DoublyNode* node) {
+	return intrusive_utility::owner<T, hook>(node);
+}
+
+template<typename T, DoublyNode T::*hook>
+const T* IntrusiveList<T, hook>::owner_(const DoublyNode* node) {
+	return intrusive_utility::owner<T, hook>(node);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+size_t IntrusiveList<T, hook>::size() const {
+	return this->size_;
+}
+
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::empty() const {
+	return this->size_ == 0;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::Iterator
+IntrusiveList<T, hook>::first_iterator() {
+	return Iterator(this, this->node_.next());
+}
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::Iterator
+IntrusiveList<T, hook>::last_iterator() {
+	return Iterator(this, this->node_.prev());
+}
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::Iterator
+IntrusiveList<T, hook>::null_iterator() {
+	return Iterator(this, &this->node_);
+}
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator
+IntrusiveList<T, hook>::first_iterator() const {
+	return ConstIterator(this, this->node_.next());
+}
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator
+IntrusiveList<T, hook>::last_iterator() const {
+	return ConstIterator(this, this->node_.prev());
+}
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator
+IntrusiveList<T, hook>::null_iterator() const {
+	return ConstIterator(this, &this->node_);
+}
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator
+IntrusiveList<T, hook>::first_const_iterator() const {
+	return ConstIterator(this, this->node_.next());
+}
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator
+IntrusiveList<T, hook>::last_const_iterator() const {
+	return ConstIterator(this, this->node_.prev());
+}
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator
+IntrusiveList<T, hook>::null_const_iterator() const {
+	return ConstIterator(this, &this->node_);
+}
+
+/*
+ * Returns the iterator to value, which should be in this list.
+*/
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::Iterator
+IntrusiveList<T, hook>::iterator(T& value) {
+	return Iterator(this, &(value.*hook));
+}
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator
+IntrusiveList<T, hook>::iterator(const T& value) const {
+	return ConstIterator(this, &(value.*hook));
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::IntrusiveList(): size_(0) {}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::IntrusiveList(IntrusiveList&& list): size_(0) {
+	this->PushListBack(list);
+}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::~IntrusiveList() {
+	this->ReleaseAll();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>&
+IntrusiveList<T, hook>::operator=(IntrusiveList&& list) {
+	if (this == &list) { return *this; }
+	this->ReleaseAll();
+	return this->PushListBack(list);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook> T& IntrusiveList<T, hook>::front() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	return *owner_(this->node_.next());
+}
+
+template<typename T, DoublyNode T::*hook>
+const T& IntrusiveList<T, hook>::front() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	return *owner_(this->node_.next());
+}
+
+template<typename T, DoublyNode T::*hook> T& IntrusiveList<T, hook>::back() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	return *owner_(this->node_.prev());
+}
+
+template<typename T, DoublyNode T::*hook>
+const T& IntrusiveList<T, hook>::back() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	return *owner_(this->node_.prev());
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::PushFront(T& value) {
+	PHI__debug_if(!(value.*hook).sole()) { PHI__throw("node error"); }
+	++this->size_;
+	this->node_.PushNext(&(value.*hook));
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::PushBack(T& value) {
+	PHI__debug_if(!(value.*hook).sole()) { PHI__throw("node error"); }
+	++this->size_;
+	this->node_.PushPrev(&(value.*hook));
+	return *this;
+}
+
+/*
+ * Links value before iter.
+*/
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::Insert(const Iterator& iter,
+													   T& value) {
+	PHI__debug_if(this != iter.list_ || iter.node_ == nullptr) {
+		PHI__throw("iter error");
+	}
+	PHI__debug_if(!(value.*hook).sole()) { PHI__throw("node error"); }
+	++this->size_;
+	iter.node_->PushPrev(&(value.*hook));
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>&
+IntrusiveList<T, hook>::PushListFront(IntrusiveList& list) {
+	if (this == &list || list.size_ == 0) { return *this; }
+	this->size_ += list.size_;
+	list.size_ = 0;
+	this->node_.next()->PushPrevRange(list.node_.next(), list.node_.prev());
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>&
+IntrusiveList<T, hook>::PushListBack(IntrusiveList& list) {
+	if (this == &list || list.size_ == 0) { return *this; }
+	this->size_ += list.size_;
+	list.size_ = 0;
+	this->node_.PushPrevRange(list.node_.next(), list.node_.prev());
+	return *this;
+}
+
+/*
+ * Relinks value, which should be in this list, to the front. O(1).
+*/
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::MoveToFront(T& value) {
+	PHI__debug_if((value.*hook).sole()) { PHI__throw("node error"); }
+	this->node_.PushNext(&(value.*hook));
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::MoveToBack(T& value) {
+	PHI__debug_if((value.*hook).sole()) { PHI__throw("node error"); }
+	this->node_.PushPrev(&(value.*hook));
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::PopFront() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("size error"); }
+	--this->size_;
+	this->node_.next()->Pop();
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::PopBack() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("size error"); }
+	--this->size_;
+	this->node_.prev()->Pop();
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::Pop(const Iterator& iter) {
+	PHI__debug_if(this != iter.list_ || iter.node_ == nullptr ||
+				  iter.node_ == &this->node_) {
+		PHI__throw("iter error");
+	}
+
+	--this->size_;
+	iter.node_->Pop();
+	const_cast<Iterator&>(iter).node_ = nullptr;
+	return *this;
+}
+
+/*
+ * Unlinks value, which should be in this list. O(1).
+*/
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>& IntrusiveList<T, hook>::Release(T& value) {
+	PHI__debug_if((value.*hook).sole()) { PHI__throw("node error"); }
+	--this->size_;
+	(value.*hook).Pop();
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+void IntrusiveList<T, hook>::ReleaseAll() {
+	this->size_ = 0;
+	while (!this->node_.sole()) { this->node_.next()->Pop(); }
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::Iterator::Iterator(const Iterator& iter):
+	list_(iter.list_), node_(iter.node_) {}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::Iterator::Iterator(IntrusiveList* list,
+										   DoublyNode* node):
+	list_(list),
+	node_(node) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::Iterator&
+IntrusiveList<T, hook>::Iterator::operator=(const Iterator& iter) {
+	this->list_ = iter.list_;
+	this->node_ = iter.node_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::Iterator::operator==(const Iterator& iter) const {
+	return this->node_ == iter.node_ && this->list_ == iter.list_;
+}
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::Iterator::operator!=(const Iterator& iter) const {
+	return this->node_ != iter.node_ || this->list_ != iter.list_;
+}
+
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::Iterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->node_ == const_iter.node_ && this->list_ == const_iter.list_;
+}
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::Iterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return this->node_ != const_iter.node_ || this->list_ != const_iter.list_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+T& IntrusiveList<T, hook>::Iterator::operator*() const {
+	return *owner_(this->node_);
+}
+template<typename T, DoublyNode T::*hook>
+T* IntrusiveList<T, hook>::Iterator::operator->() const {
+	return owner_(this->node_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::Iterator&
+IntrusiveList<T, hook>::Iterator::operator++() {
+	this->node_ = this->node_->next();
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::Iterator&
+IntrusiveList<T, hook>::Iterator::operator--() {
+	this->node_ = this->node_->prev();
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::ConstIterator::ConstIterator(const Iterator& iter):
+	list_(iter.list_), node_(iter.node_) {}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::ConstIterator::ConstIterator(
+	const ConstIterator& const_iter):
+	list_(const_iter.list_),
+	node_(const_iter.node_) {}
+
+template<typename T, DoublyNode T::*hook>
+IntrusiveList<T, hook>::ConstIterator::ConstIterator(const IntrusiveList* list,
+													 const DoublyNode* node):
+	list_(list),
+	node_(node) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator&
+IntrusiveList<T, hook>::ConstIterator::operator=(const Iterator& iter) {
+	this->list_ = iter.list_;
+	this->node_ = iter.node_;
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator&
+IntrusiveList<T, hook>::ConstIterator::operator=(
+	const ConstIterator& const_iter) {
+	this->list_ = const_iter.list_;
+	this->node_ = const_iter.node_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::ConstIterator::operator==(
+	const Iterator& iter) const {
+	return this->node_ == iter.node_ && this->list_ == iter.list_;
+}
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::ConstIterator::operator!=(
+	const Iterator& iter) const {
+	return this->node_ != iter.node_ || this->list_ != iter.list_;
+}
+
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::ConstIterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->node_ == const_iter.node_ && this->list_ == const_iter.list_;
+}
+template<typename T, DoublyNode T::*hook>
+bool IntrusiveList<T, hook>::ConstIterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return this->node_ != const_iter.node_ || this->list_ != const_iter.list_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+const T& IntrusiveList<T, hook>::ConstIterator::operator*() const {
+	return *owner_(this->node_);
+}
+template<typename T, DoublyNode T::*hook>
+const T* IntrusiveList<T, hook>::ConstIterator::operator->() const {
+	return owner_(this->node_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator&
+IntrusiveList<T, hook>::ConstIterator::operator++() {
+	this->node_ = this->node_->next();
+	return *this;
+}
+
+template<typename T, DoublyNode T::*hook>
+typename IntrusiveList<T, hook>::ConstIterator&
+IntrusiveList<T, hook>::ConstIterator::operator--() {
+	this->node_ = this->node_->prev();
+	return *this;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,363 @@
+#ifndef PHI__define_guard__Container__LRUCache_h
+#define PHI__define_guard__Container__LRUCache_h
+
+#include "../Utility/memory_op.h"
+#include "../Utility/compare.h"
+#include "ChainingHashTable.h"
+#include "IntrusiveHashTable.h"
+#include "IntrusiveList.h"
+#include "Pool.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+LRUCache maps keys to values and evicts the least recently used entry once
+the cache holds more than max_size entries or more than max_cost total cost.
+Each entry carries both hooks, one for the hash index and one for the recency
+list, in a single block recycled through a pool, so a hit is one hash lookup
+plus an O(1) relink and a miss allocates at most once.
+
+With max_protected_size != 0 the cache is a segmented LRU. New entries go to
+the probation segment, a hit in probation promotes the entry to the protected
+segment, and the least recently used protected entry is demoted back when
+protected grows beyond max_protected_size. Eviction takes probation first, so
+a scan of one-hit keys cannot flush the frequently used ones. The entry just
+put is never the victim while other entries remain, so a protected segment
+filling the cache does not starve new keys.
+*/
+
+template<typename Key, typename Value, typename Hasher = DefaultHasher,
+		 typename EqualComparer = DefaultEqualComparer>
+class LRUCache {
+private:
+	struct Entry_ {
+		Key key;
+		Value value;
+		size_t cost;
+		bool protected_;
+
+		DoublyNode recency_hook;
+		DoublyNode index_hook;
+
+		template<typename V>
+		Entry_(const Key& key, V&& value, size_t cost);
+	};
+
+	struct EntryHasher_ {
+		Hasher hasher;
+
+		hash_t operator()(const Entry_& entry) const;
+		hash_t operator()(const Key& key) const;
+	};
+
+	struct EntryEqualComparer_ {
+		EqualComparer eq_cmper;
+
+		bool eq(const Entry_& x, const Entry_& y) const;
+		bool eq(const Entry_& entry, const Key& key) const;
+	};
+
+	using Index_ = IntrusiveHashTable<Entry_, &Entry_::index_hook,
+									  EntryHasher_, EntryEqualComparer_>;
+	using RecencyList_ = IntrusiveList<Entry_, &Entry_::recency_hook>;
+
+public:
+	size_t size() const;
+	bool empty() const;
+
+	size_t cost() const;
+
+	size_t max_size() const;
+	size_t max_cost() const;
+	size_t max_protected_size() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	LRUCache(size_t max_size, size_t max_cost = size_t(-1),
+			 size_t max_protected_size = 0, const Hasher& hasher = Hasher(),
+			 const EqualComparer& eq_cmper = EqualComparer());
+
+	LRUCache(const LRUCache& cache) = delete;
+
+	~LRUCache();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	LRUCache& operator=(const LRUCache& cache) = delete;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool Contain(const Key& key) const;
+
+	Value* Get(const Key& key);
+
+	const Value* Peek(const Key& key) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename V> Value* Put(const Key& key, V&& value, size_t cost = 1);
+
+	bool Erase(const Key& key);
+	bool Evict();
+
+	void Clear();
+
+private:
+	size_t max_size_;
+	size_t max_cost_;
+	size_t max_protected_size_;
+
+	size_t cost_;
+
+	UncountedPool<sizeof(Entry_)> pool_;
+
+	Index_ index_;
+	RecencyList_ probation_;
+	RecencyList_ protected_;
+
+	void Touch_(Entry_* entry);
+	void Release_(Entry_* entry);
+	Entry_* victim_(const Entry_* keep = nullptr);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+template<typename V>
+LRUCache<Key, Value, Hasher, EqualComparer>::Entry_::Entry_(const Key& key,
+															V&& value,
+															size_t cost):
+	key(key),
+	value(Forward<V>(value)), cost(cost), protected_(false) {}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+hash_t LRUCache<Key, Value, Hasher, EqualComparer>::EntryHasher_::operator()(
+	const Entry_& entry) const {
+	return this->hasher(entry.key);
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+hash_t LRUCache<Key, Value, Hasher, EqualComparer>::EntryHasher_::operator()(
+	const Key& key) const {
+	return this->hasher(key);
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool LRUCache<Key, Value, Hasher, EqualComparer>::EntryEqualComparer_::eq(
+	const Entry_& x, const Entry_& y) const {
+	return this->eq_cmper.eq(x.key, y.key);
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool LRUCache<Key, Value, Hasher, EqualComparer>::EntryEqualComparer_::eq(
+	const Entry_& entry, const Key& key) const {
+	return this->eq_cmper.eq(entry.key, key);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t LRUCache<Key, Value, Hasher, EqualComparer>::size() const {
+	return this->index_.size();
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool LRUCache<Key, Value, Hasher, EqualComparer>::empty() const {
+	return this->index_.empty();
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t LRUCache<Key, Value, Hasher, EqualComparer>::cost() const {
+	return this->cost_;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t LRUCache<Key, Value, Hasher, EqualComparer>::max_size() const {
+	return this->max_size_;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t LRUCache<Key, Value, Hasher, EqualComparer>::max_cost() const {
+	return this->max_cost_;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t LRUCache<Key, Value, Hasher, EqualComparer>::max_protected_size() const {
+	return this->max_protected_size_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+LRUCache<Key, Value, Hasher, EqualComparer>::LRUCache(
+	size_t max_size, size_t max_cost, size_t max_protected_size,
+	const Hasher& hasher, const EqualComparer& eq_cmper):
+	max_size_(max_size),
+	max_cost_(max_cost), max_protected_size_(max_protected_size), cost_(0),
+	index_(EntryHasher_ { hasher }, EntryEqualComparer_ { eq_cmper }) {}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+LRUCache<Key, Value, Hasher, EqualComparer>::~LRUCache() {
+	this->Clear();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+void LRUCache<Key, Value, Hasher, EqualComparer>::Touch_(Entry_* entry) {
+	if (entry->protected_) {
+		this->protected_.MoveToFront(*entry);
+		return;
+	}
+
+	if (this->max_protected_size_ == 0) {
+		this->probation_.MoveToFront(*entry);
+		return;
+	}
+
+	this->probation_.Release(*entry);
+	entry->protected_ = true;
+	this->protected_.PushFront(*entry);
+
+	if (this->protected_.size() <= this->max_protected_size_) { return; }
+
+	Entry_& demoted(this->protected_.back());
+	this->protected_.PopBack();
+	demoted.protected_ = false;
+	this->probation_.PushFront(demoted);
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+void LRUCache<Key, Value, Hasher, EqualComparer>::Release_(Entry_* entry) {
+	(entry->protected_ ? this->protected_ : this->probation_).Release(*entry);
+	this->index_.Release(*entry);
+	this->cost_ -= entry->cost;
+
+	entry->~Entry_();
+	this->pool_.Push(entry);
+}
+
+/*
+ * Returns the least recently used entry of probation, or of protected if
+ * probation is empty or its last entry is keep. keep is the most recently
+ * used entry, so it is returned only if it is the last entry of the cache.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+typename LRUCache<Key, Value, Hasher, EqualComparer>::Entry_*
+LRUCache<Key, Value, Hasher, EqualComparer>::victim_(const Entry_* keep) {
+	if (this->protected_.empty() ||
+		(!this->probation_.empty() && &this->probation_.back() != keep)) {
+		return &this->probation_.back();
+	}
+
+	return &this->protected_.back();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool LRUCache<Key, Value, Hasher, EqualComparer>::Contain(
+	const Key& key) const {
+	return this->index_.Contain(key);
+}
+
+/*
+ * Returns the value of key and marks it as most recently used, or nullptr if
+ * key is not cached.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+Value* LRUCache<Key, Value, Hasher, EqualComparer>::Get(const Key& key) {
+	Entry_* entry(this->index_.Find(key));
+	if (entry == nullptr) { return nullptr; }
+	this->Touch_(entry);
+	return &entry->value;
+}
+
+/*
+ * Returns the value of key without changing the recency order.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+const Value*
+LRUCache<Key, Value, Hasher, EqualComparer>::Peek(const Key& key) const {
+	const Entry_* entry(this->index_.Find(key));
+	return entry == nullptr ? nullptr : &entry->value;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Inserts or overwrites the value of key as most recently used, then evicts
+ * other entries until the bounds hold. Returns the cached value, or nullptr if
+ * the entry alone exceeds the bounds. Such an entry is not cached, it only
+ * erases the old value of key and leaves the other entries untouched.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+template<typename V>
+Value* LRUCache<Key, Value, Hasher, EqualComparer>::Put(const Key& key,
+														V&& value,
+														size_t cost) {
+	Entry_* entry(this->index_.Find(key));
+
+	if (this->max_size_ == 0 || this->max_cost_ < cost) {
+		if (entry != nullptr) { this->Release_(entry); }
+		return nullptr;
+	}
+
+	if (entry == nullptr) {
+		entry = new (this->pool_.Pop()) Entry_(key, Forward<V>(value), cost);
+		this->index_.Insert(*entry);
+		this->probation_.PushFront(*entry);
+	} else {
+		entry->value = Forward<V>(value);
+		this->cost_ -= entry->cost;
+		entry->cost = cost;
+		this->Touch_(entry);
+	}
+
+	this->cost_ += cost;
+
+	// entry alone fits, so the victims are always other entries, protected
+	// ones too if entry is the only one in probation
+	while (this->max_size_ < this->index_.size() ||
+		   this->max_cost_ < this->cost_) {
+		this->Release_(this->victim_(entry));
+	}
+
+	return &entry->value;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool LRUCache<Key, Value, Hasher, EqualComparer>::Erase(const Key& key) {
+	Entry_* entry(this->index_.Find(key));
+	if (entry == nullptr) { return false; }
+	this->Release_(entry);
+	return true;
+}
+
+/*
+ * Evicts the least recently used entry. Returns false if the cache is empty.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool LRUCache<Key, Value, Hasher, EqualComparer>::Evict() {
+	if (this->index_.empty()) { return false; }
+	this->Release_(this->victim_());
+	return true;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+void LRUCache<Key, Value, Hasher, EqualComparer>::Clear() {
+	while (!this->index_.empty()) { this->Release_(this->victim_()); }
+}
+
+}
+}
+
+#endif
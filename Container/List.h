@@ -2,6 +2,7 @@
 #define PHI__define_guard__Container__List_h
 
 #include "../Utility/memory_op.h"
+#include "../Utility/compare.h"
 #include "DoublyNode.h"
 #include "Pool.h"
 
@@ -130,16 +131,37 @@ public:
 	List& PushListFront(List& list);
 	List& PushListBack(List& list);
 
+	List& Splice(const Iterator& iter, List& list, const Iterator& first,
+				 const Iterator& last);
+	List& Splice(const Iterator& iter, List& list, const Iterator& first,
+				 const Iterator& last, size_t size);
+
 #///////////////////////////////////////////////////////////////////////////////
 
 	List& PopFront();
 	List& PopBack();
 	List& Pop(const Iterator& iter);
 
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename LessThanComparer = DefaultLessThanComparer>
+	List& Sort(LessThanComparer&& lt_cmper = LessThanComparer());
+
+	template<typename LessThanComparer = DefaultLessThanComparer>
+	List& Merge(List& list, LessThanComparer&& lt_cmper = LessThanComparer());
+
 private:
 	size_t size_;
 	DoublyNode node_;
 	UncountedPool<sizeof(Node)> pool_;
+
+	static const T& value_(const DoublyNode* node);
+
+	static void MoveAll_(DoublyNode& dst, DoublyNode& src);
+
+	template<typename LessThanComparer>
+	static void Merge_(DoublyNode& dst, DoublyNode& src,
+					   LessThanComparer& lt_cmper);
 };
 
 #///////////////////////////////////////////////////////////////////////////////
@@ -203,15 +225,15 @@ typename List<T>::ConstIterator List<T>::null_const_iterator() const {
 template<typename T> List<T>::List(): size_(0) {}
 
 template<typename T> List<T>::List(const List& list): size_(list.size_) {
-	for (Node* i(list.node_.next()); i != list.node_;
-		 i = static_cast<Node*>(i->next())) {
-		this->node_.PushPrev(New<Node>(i->value));
+	for (const DoublyNode* i(list.node_.next()); i != &list.node_;
+		 i = i->next()) {
+		this->node_.PushPrev(New<Node>(value_(i)));
 	}
 }
 
 template<typename T> List<T>::List(List&& list): size_(list.size_) {
 	list.size_ = 0;
-	Node::Swap(this->node_, list.node_);
+	MoveAll_(this->node_, list.node_);
 	list.pool_.TransferTo(this->pool_);
 }
 
@@ -223,34 +245,33 @@ template<typename T> List<T>::~List() {
 #///////////////////////////////////////////////////////////////////////////////
 
 template<typename T> List<T>& List<T>::operator=(const List& list) {
-	Node* i(static_cast<Node*>(this->node_.next()));
-	Node* j(static_cast<Node*>(list.node_.next()));
+	if (this == &list) { return *this; }
+
+	DoublyNode* i(this->node_.next());
+	const DoublyNode* j(list.node_.next());
 
 	if (this->size_ < list.size_) {
-		for (; i != &this->node_; i = static_cast<Node*>(i->next()),
-								  j = static_cast<Node*>(j->next())) {
-			i->value = j->value;
+		for (; i != &this->node_; i = i->next(), j = j->next()) {
+			static_cast<Node*>(i)->value = value_(j);
 		}
 
-		for (; !this->pool_.empty() && j != &list.node_;
-			 j = static_cast<Node*>(j->next())) {
-			this->node_.PushPrev(new (this->pool_.Pop()) Node(j->value));
+		for (; !this->pool_.empty() && j != &list.node_; j = j->next()) {
+			this->node_.PushPrev(new (this->pool_.Pop()) Node(value_(j)));
 		}
 
-		for (; j != &list.node_; j = static_cast<Node*>(j->next())) {
-			this->node_.PushPrev(New<Node>(j->value));
+		for (; j != &list.node_; j = j->next()) {
+			this->node_.PushPrev(New<Node>(value_(j)));
 		}
 	} else {
-		for (; j != &list.node_; i = static_cast<Node*>(i->next()),
-								 j = static_cast<Node*>(j->next())) {
-			i->value = j->value;
+		for (; j != &list.node_; i = i->next(), j = j->next()) {
+			static_cast<Node*>(i)->value = value_(j);
 		}
 
-		Node* node;
-
-		while ((node = static_cast<Node*>(this->node_.prev())) != i) {
+		while (i != &this->node_) {
+			Node* node(static_cast<Node*>(i));
+			i = i->next();
 			node->value.~T();
-			this->pool_.PushPrev(node->Pop());
+			this->pool_.Push(node->Pop());
 		}
 	}
 
@@ -260,16 +281,19 @@ template<typename T> List<T>& List<T>::operator=(const List& list) {
 }
 
 template<typename T> List<T>& List<T>::operator=(List&& list) {
+	if (this == &list) { return *this; }
+
 	this->size_ = list.size_;
+	list.size_ = 0;
 
 	while (!this->node_.sole()) {
 		Node* i(static_cast<Node*>(this->node_.prev()));
 		i->value.~T();
-		this->pool_.PushPrev(i);
+		this->pool_.Push(i->Pop());
 	}
 
-	Node::Swap(this->node_, list.node_);
-	list.pool_.TtansferTo(this->pool_);
+	MoveAll_(this->node_, list.node_);
+	list.pool_.TransferTo(this->pool_);
 
 	return *this;
 }
@@ -327,15 +351,57 @@ template<typename T> List<T>& List<T>::PushNodeBack(Node* node) {
 }
 
 template<typename T> List<T>& List<T>::PushListFront(List<T>& list) {
+	if (this == &list) { return *this; }
 	this->size_ += list.size_;
 	list.size_ = 0;
-	this->node_.PushNextAllExcept(&list.node_);
+	MoveAll_(*this->node_.next(), list.node_);
 	return *this;
 }
 template<typename T> List<T>& List<T>::PushListBack(List<T>& list) {
+	if (this == &list) { return *this; }
 	this->size_ += list.size_;
 	list.size_ = 0;
-	this->node_.PushPrevAllExcept(&list.node_);
+	MoveAll_(this->node_, list.node_);
+	return *this;
+}
+
+/*
+ * Moves [first, last) of list before iter by relinking the nodes. iter should
+ * not be in [first, last). Counts the moved nodes when list is not this, pass
+ * size, the number of nodes in [first, last), to skip the counting.
+*/
+template<typename T>
+List<T>& List<T>::Splice(const Iterator& iter, List& list,
+						 const Iterator& first, const Iterator& last) {
+	size_t size(0);
+
+	if (this != &list) {
+		for (DoublyNode* i(first.node_); i != last.node_; i = i->next()) {
+			++size;
+		}
+	}
+
+	return this->Splice(iter, list, first, last, size);
+}
+
+template<typename T>
+List<T>& List<T>::Splice(const Iterator& iter, List& list,
+						 const Iterator& first, const Iterator& last,
+						 size_t size) {
+	PHI__debug_if(this != iter.list_ || &list != first.list_ ||
+				  &list != last.list_) {
+		PHI__throw("iter error");
+	}
+
+	if (first.node_ == last.node_) { return *this; }
+
+	iter.node_->PushPrevRange(first.node_, last.node_->prev());
+
+	if (this != &list) {
+		this->size_ += size;
+		list.size_ -= size;
+	}
+
 	return *this;
 }
 
@@ -372,6 +438,103 @@ template<typename T> List<T>& List<T>::Pop(const Iterator& iter) {
 	return *this;
 }
 
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T> const T& List<T>::value_(const DoublyNode* node) {
+	return static_cast<const Node*>(node)->value;
+}
+
+/*
+ * Moves all nodes after the sentinel src before dst.
+*/
+template<typename T> void List<T>::MoveAll_(DoublyNode& dst, DoublyNode& src) {
+	if (!src.sole()) { dst.PushPrevRange(src.next(), src.prev()); }
+}
+
+/*
+ * Merges the sorted nodes after the sentinel src into the sorted nodes after
+ * the sentinel dst. Nodes of dst go before equal nodes of src. Each step moves
+ * the whole run of src which goes before the current node of dst.
+*/
+template<typename T>
+template<typename LessThanComparer>
+void List<T>::Merge_(DoublyNode& dst, DoublyNode& src,
+					 LessThanComparer& lt_cmper) {
+	DoublyNode* i(dst.next());
+
+	while (!src.sole()) {
+		DoublyNode* j(src.next());
+
+		while (i != &dst && !lt_cmper.lt(value_(j), value_(i))) {
+			i = i->next();
+		}
+
+		if (i == &dst) {
+			dst.PushPrevRange(j, src.prev());
+			return;
+		}
+
+		DoublyNode* k(j->next());
+
+		while (k != &src && lt_cmper.lt(value_(k), value_(i))) {
+			k = k->next();
+		}
+
+		i->PushPrevRange(j, k->prev());
+	}
+}
+
+/*
+ * Stable bottom-up merge sort by relinking the nodes, no allocation. bins[i]
+ * holds a sorted run of 2^i nodes or is empty, like a binary counter.
+*/
+template<typename T>
+template<typename LessThanComparer>
+List<T>& List<T>::Sort(LessThanComparer&& lt_cmper) {
+	if (this->size_ < 2) { return *this; }
+
+	DoublyNode carry;
+	DoublyNode bins[64];
+	size_t fill(0);
+
+	while (!this->node_.sole()) {
+		carry.PushPrev(this->node_.next());
+
+		size_t i(0);
+
+		for (; i != fill && !bins[i].sole(); ++i) {
+			Merge_(bins[i], carry, lt_cmper);
+			MoveAll_(carry, bins[i]);
+		}
+
+		MoveAll_(bins[i], carry);
+		if (i == fill) { ++fill; }
+	}
+
+	for (size_t i(1); i < fill; ++i) { Merge_(bins[i], bins[i - 1], lt_cmper); }
+
+	MoveAll_(this->node_, bins[fill - 1]);
+
+	return *this;
+}
+
+/*
+ * Merges the sorted list into this sorted list by relinking the nodes. Elements
+ * of this go before equal elements of list.
+*/
+template<typename T>
+template<typename LessThanComparer>
+List<T>& List<T>::Merge(List& list, LessThanComparer&& lt_cmper) {
+	if (this == &list) { return *this; }
+
+	Merge_(this->node_, list.node_, lt_cmper);
+
+	this->size_ += list.size_;
+	list.size_ = 0;
+
+	return *this;
+}
+
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
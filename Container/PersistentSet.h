@@ -0,0 +1,848 @@
+#ifndef PHI__define_guard__Container__PersistentSet_h
+#define PHI__define_guard__Container__PersistentSet_h
+
+#include <atomic>
+#include "../Utility/memory_op.h"
+#include "../Utility/compare.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+PersistentSet is a red-black tree whose nodes are reference counted and shared
+between instances. Copying a PersistentSet (or calling Snapshot) is O(1), it
+only acquires the root. Insert and FindErase copy the nodes on the search path
+which are shared with other instances (path copying), so an update costs
+O(log n) new nodes at most and never changes what other snapshots see. Nodes
+owned by a single instance are modified in place.
+
+Reference counts are atomic, so snapshots may be copied and destroyed on
+different threads. One instance must not be modified by a thread while other
+threads are reading the same instance, hand each reader its own snapshot.
+
+Nodes have no parent link (a shared node has many parents), so iterators keep
+their search path.
+*/
+
+template<typename T, typename FullComparer = DefaultFullComparer>
+class PersistentSet {
+public:
+	static constexpr bool black = false;
+	static constexpr bool red = true;
+
+	static constexpr size_t max_height = 2 * 8 * sizeof(size_t);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	struct Node {
+		friend class PersistentSet;
+
+		T value;
+
+		template<typename... Args> Node(Args&&... args);
+
+	private:
+		std::atomic<size_t> ref_;
+		Node* l_;
+		Node* r_;
+		bool color_;
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	class ConstIterator {
+		friend class PersistentSet;
+
+	public:
+		ConstIterator(const ConstIterator& const_iter);
+
+		ConstIterator& operator=(const ConstIterator& const_iter);
+
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		const T& operator*() const;
+		const T* operator->() const;
+
+		ConstIterator& operator++();
+		ConstIterator& operator--();
+
+	private:
+		const PersistentSet* set_;
+		size_t depth_;
+		const Node* path_[max_height];
+
+		ConstIterator(const PersistentSet* set);
+
+		const Node* node_() const;
+
+		void PushMostL_(const Node* node);
+		void PushMostR_(const Node* node);
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const;
+	bool empty() const;
+
+	const FullComparer& full_cmper() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	ConstIterator first_iterator() const;
+	ConstIterator last_iterator() const;
+	ConstIterator null_iterator() const;
+
+	ConstIterator first_const_iterator() const;
+	ConstIterator last_const_iterator() const;
+	ConstIterator null_const_iterator() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	PersistentSet(const FullComparer& full_cmper = FullComparer());
+	PersistentSet(const PersistentSet& set);
+	PersistentSet(PersistentSet&& set);
+
+	~PersistentSet();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	PersistentSet& operator=(const PersistentSet& set);
+	PersistentSet& operator=(PersistentSet&& set);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool operator==(const PersistentSet& set) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	PersistentSet Snapshot() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> bool Contain(const Index& index) const;
+
+	template<typename Index> ConstIterator Find(const Index& index) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename... Args> bool Insert(Args&&... args);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> bool FindErase(const Index& index);
+
+	void Clear();
+
+	void Check() const;
+
+private:
+	size_t size_;
+	Node* root_;
+
+	FullComparer full_cmper_;
+
+	template<typename Index> const Node* Find_(const Index& index) const;
+
+	Node* Insert_(Node* n, Node* node);
+	template<typename Index> Node* Erase_(Node* n, const Index& index);
+
+	static bool is_red_(const Node* n);
+	static bool is_black_(const Node* n);
+
+	static Node* Acquire_(Node* n);
+	static void Release_(Node* n);
+
+	static Node* Mutable_(Node* n);
+	static Node* Unpack_(Node* n, Node*& l, Node*& r);
+	static Node* Pack_(bool color, Node* l, Node* n, Node* r);
+
+	static Node* MakeBlack_(Node* n);
+	static Node* MakeRed_(Node* n);
+
+	static Node* Balance_(Node* l, Node* n, Node* r);
+	static Node* BalanceL_(Node* l, Node* n, Node* r);
+	static Node* BalanceR_(Node* l, Node* n, Node* r);
+	static Node* Append_(Node* l, Node* r);
+
+	static size_t Check_(const Node* n);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+PersistentSet<T, FullComparer>::Node::Node(Args&&... args):
+	value(Forward<Args>(args)...), ref_(1), l_(nullptr), r_(nullptr),
+	color_(red) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+size_t PersistentSet<T, FullComparer>::size() const {
+	return this->size_;
+}
+
+template<typename T, typename FullComparer>
+bool PersistentSet<T, FullComparer>::empty() const {
+	return this->size_ == 0;
+}
+
+template<typename T, typename FullComparer>
+const FullComparer& PersistentSet<T, FullComparer>::full_cmper() const {
+	return this->full_cmper_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator
+PersistentSet<T, FullComparer>::first_iterator() const {
+	ConstIterator r(this);
+	r.PushMostL_(this->root_);
+	return r;
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator
+PersistentSet<T, FullComparer>::last_iterator() const {
+	ConstIterator r(this);
+	r.PushMostR_(this->root_);
+	return r;
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator
+PersistentSet<T, FullComparer>::null_iterator() const {
+	return ConstIterator(this);
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator
+PersistentSet<T, FullComparer>::first_const_iterator() const {
+	return this->first_iterator();
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator
+PersistentSet<T, FullComparer>::last_const_iterator() const {
+	return this->last_iterator();
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator
+PersistentSet<T, FullComparer>::null_const_iterator() const {
+	return ConstIterator(this);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>::PersistentSet(const FullComparer& full_cmper):
+	size_(0), root_(nullptr), full_cmper_(full_cmper) {}
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>::PersistentSet(const PersistentSet& set):
+	size_(set.size_), root_(Acquire_(set.root_)),
+	full_cmper_(set.full_cmper_) {}
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>::PersistentSet(PersistentSet&& set):
+	size_(set.size_), root_(set.root_), full_cmper_(Move(set.full_cmper_)) {
+	set.size_ = 0;
+	set.root_ = nullptr;
+}
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>::~PersistentSet() {
+	this->Clear();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>&
+PersistentSet<T, FullComparer>::operator=(const PersistentSet& set) {
+	if (this == &set) { return *this; }
+
+	Node* root(Acquire_(set.root_));
+	Release_(this->root_);
+
+	this->size_ = set.size_;
+	this->root_ = root;
+	this->full_cmper_ = set.full_cmper_;
+
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>&
+PersistentSet<T, FullComparer>::operator=(PersistentSet&& set) {
+	if (this == &set) { return *this; }
+
+	Release_(this->root_);
+
+	this->size_ = set.size_;
+	this->root_ = set.root_;
+	this->full_cmper_ = Move(set.full_cmper_);
+
+	set.size_ = 0;
+	set.root_ = nullptr;
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool PersistentSet<T, FullComparer>::operator==(
+	const PersistentSet& set) const {
+	if (this->root_ == set.root_) { return true; }
+	if (this->size_ != set.size_) { return false; }
+
+	ConstIterator i(this->first_iterator());
+	ConstIterator j(set.first_iterator());
+
+	for (; i.depth_ != 0; ++i, ++j) {
+		if (this->full_cmper_(*i, *j) != 0) { return false; }
+	}
+
+	return true;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>
+PersistentSet<T, FullComparer>::Snapshot() const {
+	return PersistentSet(*this);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename Index>
+const typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Find_(const Index& index) const {
+	for (const Node* n(this->root_); n != nullptr;) {
+		switch (this->full_cmper_(index, n->value)) {
+			case -1: n = n->l_; break;
+			case 1: n = n->r_; break;
+			case 0: return n;
+		}
+	}
+
+	return nullptr;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool PersistentSet<T, FullComparer>::Contain(const Index& index) const {
+	return this->Find_(index) != nullptr;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename PersistentSet<T, FullComparer>::ConstIterator
+PersistentSet<T, FullComparer>::Find(const Index& index) const {
+	ConstIterator r(this);
+
+	for (const Node* n(this->root_); n != nullptr;) {
+		r.path_[r.depth_++] = n;
+
+		switch (this->full_cmper_(index, n->value)) {
+			case -1: n = n->l_; break;
+			case 1: n = n->r_; break;
+			case 0: return r;
+		}
+	}
+
+	r.depth_ = 0;
+	return r;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool PersistentSet<T, FullComparer>::is_red_(const Node* n) {
+	return n != nullptr && n->color_ == red;
+}
+
+template<typename T, typename FullComparer>
+bool PersistentSet<T, FullComparer>::is_black_(const Node* n) {
+	return n != nullptr && n->color_ == black;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Acquire_(Node* n) {
+	if (n != nullptr) { n->ref_.fetch_add(1, std::memory_order_relaxed); }
+	return n;
+}
+
+template<typename T, typename FullComparer>
+void PersistentSet<T, FullComparer>::Release_(Node* n) {
+	if (n == nullptr ||
+		n->ref_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+		return;
+	}
+
+	Release_(n->l_);
+	Release_(n->r_);
+	Delete(n);
+}
+
+/*
+Takes the reference of n, returns a node which is only referenced by the
+caller and holds the same value, color and children as n. n is returned
+directly if the caller is its only owner.
+*/
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Mutable_(Node* n) {
+	if (n->ref_.load(std::memory_order_acquire) == 1) { return n; }
+
+	Node* m(New<Node>(n->value));
+	m->l_ = Acquire_(n->l_);
+	m->r_ = Acquire_(n->r_);
+	m->color_ = n->color_;
+
+	Release_(n);
+
+	return m;
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Unpack_(Node* n, Node*& l, Node*& r) {
+	n = Mutable_(n);
+	l = n->l_;
+	r = n->r_;
+	n->l_ = nullptr;
+	n->r_ = nullptr;
+	return n;
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Pack_(bool color, Node* l, Node* n, Node* r) {
+	n->color_ = color;
+	n->l_ = l;
+	n->r_ = r;
+	return n;
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::MakeBlack_(Node* n) {
+	if (n == nullptr || n->color_ == black) { return n; }
+	n = Mutable_(n);
+	n->color_ = black;
+	return n;
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::MakeRed_(Node* n) {
+	if (n->color_ == red) { return n; }
+	n = Mutable_(n);
+	n->color_ = red;
+	return n;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+The balancing follows Kahrs' functional red-black trees. Every function takes
+the references of its arguments and returns a referenced subtree. n is always
+an unpacked node (only referenced by the caller, no children).
+*/
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Balance_(Node* l, Node* n, Node* r) {
+	Node* a;
+	Node* b;
+	Node* c;
+	Node* d;
+
+	if (is_red_(l) && is_red_(r)) {
+		return Pack_(red, MakeBlack_(l), n, MakeBlack_(r));
+	}
+
+	if (is_red_(l)) {
+		if (is_red_(l->l_)) {
+			Node* y(Unpack_(l, a, c));
+			return Pack_(red, MakeBlack_(a), y, Pack_(black, c, n, r));
+		}
+
+		if (is_red_(l->r_)) {
+			Node* x(Unpack_(l, a, c));
+			Node* y(Unpack_(c, b, c));
+			return Pack_(red, Pack_(black, a, x, b), y, Pack_(black, c, n, r));
+		}
+	}
+
+	if (is_red_(r)) {
+		if (is_red_(r->r_)) {
+			Node* y(Unpack_(r, b, d));
+			return Pack_(red, Pack_(black, l, n, b), y, MakeBlack_(d));
+		}
+
+		if (is_red_(r->l_)) {
+			Node* z(Unpack_(r, b, d));
+			Node* y(Unpack_(b, b, c));
+			return Pack_(red, Pack_(black, l, n, b), y, Pack_(black, c, z, d));
+		}
+	}
+
+	return Pack_(black, l, n, r);
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::BalanceL_(Node* l, Node* n, Node* r) {
+	if (is_red_(l)) { return Pack_(red, MakeBlack_(l), n, r); }
+	if (is_black_(r)) { return Balance_(l, n, MakeRed_(r)); }
+
+	PHI__debug_if(!is_red_(r) || !is_black_(r->l_)) {
+		PHI__throw("tree error");
+	}
+
+	Node* a;
+	Node* b;
+	Node* c;
+
+	Node* z(Unpack_(r, a, c));
+	Node* y(Unpack_(a, a, b));
+
+	return Pack_(red, Pack_(black, l, n, a), y,
+				 Balance_(b, z, MakeRed_(c)));
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::BalanceR_(Node* l, Node* n, Node* r) {
+	if (is_red_(r)) { return Pack_(red, l, n, MakeBlack_(r)); }
+	if (is_black_(l)) { return Balance_(MakeRed_(l), n, r); }
+
+	PHI__debug_if(!is_red_(l) || !is_black_(l->r_)) {
+		PHI__throw("tree error");
+	}
+
+	Node* a;
+	Node* b;
+	Node* c;
+
+	Node* x(Unpack_(l, a, c));
+	Node* y(Unpack_(c, b, c));
+
+	return Pack_(red, Balance_(MakeRed_(a), x, b), y,
+				 Pack_(black, c, n, r));
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Append_(Node* l, Node* r) {
+	if (l == nullptr) { return r; }
+	if (r == nullptr) { return l; }
+
+	Node* a;
+	Node* b;
+	Node* c;
+	Node* d;
+
+	if (l->color_ == r->color_) {
+		bool color(l->color_);
+
+		Node* x(Unpack_(l, a, b));
+		Node* y(Unpack_(r, c, d));
+		Node* m(Append_(b, c));
+
+		if (is_red_(m)) {
+			Node* z(Unpack_(m, b, c));
+			return Pack_(red, Pack_(color, a, x, b), z, Pack_(color, c, y, d));
+		}
+
+		if (color == red) {
+			return Pack_(red, a, x, Pack_(red, m, y, d));
+		}
+
+		return BalanceL_(a, x, Pack_(black, m, y, d));
+	}
+
+	if (r->color_ == red) {
+		Node* x(Unpack_(r, b, c));
+		return Pack_(red, Append_(l, b), x, c);
+	}
+
+	Node* x(Unpack_(l, a, b));
+	return Pack_(red, a, x, Append_(b, r));
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Insert_(Node* n, Node* node) {
+	if (n == nullptr) { return node; }
+
+	bool color(n->color_);
+	Node* l;
+	Node* r;
+
+	if (this->full_cmper_(node->value, n->value) == -1) {
+		n = Unpack_(n, l, r);
+		l = this->Insert_(l, node);
+	} else {
+		n = Unpack_(n, l, r);
+		r = this->Insert_(r, node);
+	}
+
+	return color == black ? Balance_(l, n, r) : Pack_(red, l, n, r);
+}
+
+template<typename T, typename FullComparer>
+template<typename... Args>
+bool PersistentSet<T, FullComparer>::Insert(Args&&... args) {
+	Node* node(New<Node>(Forward<Args>(args)...));
+
+	if (this->Find_(node->value) != nullptr) {
+		Delete(node);
+		return false;
+	}
+
+	++this->size_;
+	this->root_ = MakeBlack_(this->Insert_(this->root_, node));
+
+	return true;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::Erase_(Node* n, const Index& index) {
+	int c(this->full_cmper_(index, n->value));
+
+	Node* l;
+	Node* r;
+
+	if (c == 0) {
+		Release_(Unpack_(n, l, r));
+		return Append_(l, r);
+	}
+
+	if (c == -1) {
+		bool l_is_black(is_black_(n->l_));
+		n = Unpack_(n, l, r);
+		l = this->Erase_(l, index);
+		return l_is_black ? BalanceL_(l, n, r) : Pack_(red, l, n, r);
+	}
+
+	bool r_is_black(is_black_(n->r_));
+	n = Unpack_(n, l, r);
+	r = this->Erase_(r, index);
+	return r_is_black ? BalanceR_(l, n, r) : Pack_(red, l, n, r);
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool PersistentSet<T, FullComparer>::FindErase(const Index& index) {
+	if (this->Find_(index) == nullptr) { return false; }
+
+	--this->size_;
+	this->root_ = MakeBlack_(this->Erase_(this->root_, index));
+
+	return true;
+}
+
+template<typename T, typename FullComparer>
+void PersistentSet<T, FullComparer>::Clear() {
+	Release_(this->root_);
+	this->size_ = 0;
+	this->root_ = nullptr;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+size_t PersistentSet<T, FullComparer>::Check_(const Node* n) {
+	if (n == nullptr) { return 0; }
+
+	if (n->color_ == red && (is_red_(n->l_) || is_red_(n->r_))) {
+		std::cout << "color error\n";
+	}
+
+	size_t l_bh(Check_(n->l_));
+	size_t r_bh(Check_(n->r_));
+
+	if (l_bh != r_bh) { std::cout << "bh error\n"; }
+
+	return n->color_ == black ? l_bh + 1 : l_bh;
+}
+
+template<typename T, typename FullComparer>
+void PersistentSet<T, FullComparer>::Check() const {
+	if (is_red_(this->root_)) { std::cout << "root color error\n"; }
+	Check_(this->root_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>::ConstIterator::ConstIterator(
+	const PersistentSet* set):
+	set_(set),
+	depth_(0) {}
+
+template<typename T, typename FullComparer>
+PersistentSet<T, FullComparer>::ConstIterator::ConstIterator(
+	const ConstIterator& const_iter):
+	set_(const_iter.set_),
+	depth_(const_iter.depth_) {
+	for (size_t i(0); i != this->depth_; ++i) {
+		this->path_[i] = const_iter.path_[i];
+	}
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator&
+PersistentSet<T, FullComparer>::ConstIterator::operator=(
+	const ConstIterator& const_iter) {
+	this->set_ = const_iter.set_;
+	this->depth_ = const_iter.depth_;
+
+	for (size_t i(0); i != this->depth_; ++i) {
+		this->path_[i] = const_iter.path_[i];
+	}
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+const typename PersistentSet<T, FullComparer>::Node*
+PersistentSet<T, FullComparer>::ConstIterator::node_() const {
+	return this->depth_ == 0 ? nullptr : this->path_[this->depth_ - 1];
+}
+
+template<typename T, typename FullComparer>
+void PersistentSet<T, FullComparer>::ConstIterator::PushMostL_(
+	const Node* node) {
+	for (; node != nullptr; node = node->l_) {
+		this->path_[this->depth_++] = node;
+	}
+}
+
+template<typename T, typename FullComparer>
+void PersistentSet<T, FullComparer>::ConstIterator::PushMostR_(
+	const Node* node) {
+	for (; node != nullptr; node = node->r_) {
+		this->path_[this->depth_++] = node;
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool PersistentSet<T, FullComparer>::ConstIterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->node_() == const_iter.node_() &&
+		   this->set_ == const_iter.set_;
+}
+
+template<typename T, typename FullComparer>
+bool PersistentSet<T, FullComparer>::ConstIterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return this->node_() != const_iter.node_() ||
+		   this->set_ != const_iter.set_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+const T& PersistentSet<T, FullComparer>::ConstIterator::operator*() const {
+	PHI__debug_if(this->depth_ == 0) { PHI__throw("iter error"); }
+	return this->path_[this->depth_ - 1]->value;
+}
+
+template<typename T, typename FullComparer>
+const T* PersistentSet<T, FullComparer>::ConstIterator::operator->() const {
+	PHI__debug_if(this->depth_ == 0) { PHI__throw("iter error"); }
+	return &this->path_[this->depth_ - 1]->value;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator&
+PersistentSet<T, FullComparer>::ConstIterator::operator++() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+
+	if (this->depth_ == 0) {
+		this->PushMostL_(this->set_->root_);
+		return *this;
+	}
+
+	const Node* n(this->path_[this->depth_ - 1]);
+
+	if (n->r_ != nullptr) {
+		this->PushMostL_(n->r_);
+		return *this;
+	}
+
+	while (--this->depth_ != 0 && this->path_[this->depth_ - 1]->r_ == n) {
+		n = this->path_[this->depth_ - 1];
+	}
+
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+typename PersistentSet<T, FullComparer>::ConstIterator&
+PersistentSet<T, FullComparer>::ConstIterator::operator--() {
+	PHI__debug_if(this->set_ == nullptr) { PHI__throw("iter error"); }
+
+	if (this->depth_ == 0) {
+		this->PushMostR_(this->set_->root_);
+		return *this;
+	}
+
+	const Node* n(this->path_[this->depth_ - 1]);
+
+	if (n->l_ != nullptr) {
+		this->PushMostR_(n->l_);
+		return *this;
+	}
+
+	while (--this->depth_ != 0 && this->path_[this->depth_ - 1]->l_ == n) {
+		n = this->path_[this->depth_ - 1];
+	}
+
+	return *this;
+}
+
+}
+}
+
+#endif
@@ -81,7 +81,7 @@ private:
 
 template<size_t BlockSize>
 void UncountedPool<BlockSize>::Node::PushPrevAllExcept(Node* node) {
-	this->PushPrevAllExcept(node);
+	this->DoublyNode::PushPrevAllExcept(node);
 }
 
 #///////////////////////////////////////////////////////////////////////////////
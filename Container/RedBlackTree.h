@@ -63,6 +63,7 @@ public:
 #///////////////////////////////////////////////////////////////////////////////
 
 	RedBlackTreeNode* Insert(RedBlackTreeNode* node);
+	RedBlackTreeNode* Insert(RedBlackTreeNode* hint, RedBlackTreeNode* node);
 
 #///////////////////////////////////////////////////////////////////////////////
 
@@ -90,6 +91,7 @@ protected:
 
 	template<typename Index> RedBlackTreeNode* Find_(const Index& index) const;
 	RedBlackTreeNode* Insert_(RedBlackTreeNode* node);
+	RedBlackTreeNode* Insert_(RedBlackTreeNode* hint, RedBlackTreeNode* node);
 	void Release_(RedBlackTreeNode* node);
 
 	static void Clear_(RedBlackTreeNode* node);
@@ -312,6 +314,65 @@ RedBlackTreeNode* RedBlackTree<FullComparer>::Insert(RedBlackTreeNode* node) {
 	return this->Insert_(node);
 }
 
+/*
+ * Inserts node next to hint (after the last node if hint is nullptr) when it
+ * belongs there, which costs at most two comparisons and an amortized O(1)
+ * fix-up. Falls back to searching from the root otherwise.
+*/
+template<typename FullComparer>
+RedBlackTreeNode* RedBlackTree<FullComparer>::Insert_(RedBlackTreeNode* hint,
+													 RedBlackTreeNode* node) {
+	if (this->size_ == 0) { return this->Insert_(node); }
+
+	RedBlackTreeNode* l;
+	RedBlackTreeNode* r;
+
+	if (hint == nullptr) {
+		l = this->last_node_();
+		r = nullptr;
+	} else {
+		switch (this->full_cmper_(node, hint)) {
+			case -1:
+				l = hint->prev();
+				r = hint;
+				break;
+			case 1:
+				l = hint;
+				r = hint->next();
+				break;
+			case 0: return hint;
+		}
+	}
+
+	if (l != nullptr && l != hint && this->full_cmper_(l, node) != -1) {
+		return this->Insert_(node);
+	}
+
+	if (r != nullptr && r != hint && this->full_cmper_(node, r) != -1) {
+		return this->Insert_(node);
+	}
+
+	// l and r are adjacent, so l->r() or r->l() is empty
+
+	if (l != nullptr && l->r() == nullptr) {
+		l->InsertR(node);
+	} else {
+		r->InsertL(node);
+	}
+
+	++this->size_;
+	this->root_ = this->root_->most_p();
+
+	return node;
+}
+
+template<typename FullComparer>
+RedBlackTreeNode* RedBlackTree<FullComparer>::Insert(RedBlackTreeNode* hint,
+													RedBlackTreeNode* node) {
+	PHI__debug_if(!node->sole()) { PHI__throw("node is not sole"); }
+	return this->Insert_(hint, node);
+}
+
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
@@ -61,7 +61,7 @@ struct RedBlackTreeNode: public TreeNode {
 
 #///////////////////////////////////////////////////////////////////////////////
 
-#if PHI__debug
+#if PHI__debug_flag
 	inline size_t Check() const;
 #endif
 
@@ -365,7 +365,7 @@ void RedBlackTreeNode::ReleaseAll_(RedBlackTreeNode* n) {
 
 #///////////////////////////////////////////////////////////////////////////////
 
-#if PHI__debug
+#if PHI__debug_flag
 
 size_t RedBlackTreeNode::Check() const {
 	if (this->p_ != nullptr) {
@@ -17,6 +17,7 @@ public:
 	class RBT;
 	class Iterator;
 	class ConstIterator;
+	class NodeHandle;
 
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
@@ -138,6 +139,32 @@ public:
 		ConstIterator(const Set* set, const Node* node);
 	};
 
+	/*
+	NodeHandle owns a node extracted from a Set. The value stays in place until
+	the node is inserted into another Set of the same type or the handle is
+	destroyed.
+	*/
+	class NodeHandle {
+		friend class Set;
+
+	public:
+		NodeHandle();
+		NodeHandle(NodeHandle&& node_handle);
+
+		~NodeHandle();
+
+		NodeHandle& operator=(NodeHandle&& node_handle);
+
+		bool empty() const;
+
+		T& value() const;
+
+	private:
+		Node* node_;
+
+		NodeHandle(Node* node);
+	};
+
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
@@ -197,6 +224,12 @@ public:
 
 	template<typename... Args> pair<Iterator, bool> Insert(Args&&... args);
 
+	template<typename... Args>
+	pair<Iterator, bool> InsertHint(const ConstIterator& hint, Args&&... args);
+
+	template<typename... Args>
+	pair<Iterator, bool> AppendSorted(Args&&... args);
+
 #///////////////////////////////////////////////////////////////////////////////
 
 	void Release(const Iterator& iter);
@@ -206,6 +239,15 @@ public:
 
 	void Clear();
 
+#///////////////////////////////////////////////////////////////////////////////
+
+	NodeHandle Extract(const Iterator& iter);
+	template<typename Index> NodeHandle FindExtract(const Index& index);
+
+	pair<Iterator, bool> InsertNode(NodeHandle&& node_handle);
+
+	void Merge(Set& set);
+
 	void Check() const { this->rbt_.root_->Check(); }
 
 private:
@@ -227,6 +269,8 @@ private:
 
 	void EnPool_(Node* n);
 
+	Node* Extract_(Node* node);
+
 	static void Destruct_(Node* n);
 };
 
@@ -659,6 +703,41 @@ Set<T, FullComparer>::Insert(Args&&... args) {
 	return pair<Iterator, bool>(Iterator(this, n), false);
 }
 
+/*
+ * Inserts the value next to hint in amortized O(1) if it belongs there,
+ * otherwise the same as Insert.
+*/
+template<typename T, typename FullComparer>
+template<typename... Args>
+pair<typename Set<T, FullComparer>::Iterator, bool>
+Set<T, FullComparer>::InsertHint(const ConstIterator& hint, Args&&... args) {
+	PHI__debug_if(this != hint.set_) { PHI__throw("iter error"); }
+
+	Node* node(new (this->pool_.Pop()) Node(Forward<Args>(args)...));
+	Node* n(static_cast<Node*>(this->rbt_.Insert(
+		const_cast<Node*>(hint.node_), static_cast<RedBlackTreeNode*>(node))));
+
+	if (node == n) {
+		return pair<Iterator, bool>(Iterator(this, static_cast<Node*>(node)),
+									true);
+	}
+
+	this->pool_.Push(node);
+	return pair<Iterator, bool>(Iterator(this, n), false);
+}
+
+/*
+ * Fast path for sorted streams, the value is attached after the last element
+ * if it is greater than the last element, otherwise the same as Insert.
+*/
+template<typename T, typename FullComparer>
+template<typename... Args>
+pair<typename Set<T, FullComparer>::Iterator, bool>
+Set<T, FullComparer>::AppendSorted(Args&&... args) {
+	return this->InsertHint(this->null_const_iterator(),
+							Forward<Args>(args)...);
+}
+
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
@@ -698,6 +777,73 @@ template<typename T, typename FullComparer> void Set<T, FullComparer>::Clear() {
 	this->rbt_.root_ = nullptr;
 }
 
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename Set<T, FullComparer>::Node*
+Set<T, FullComparer>::Extract_(Node* node) {
+	this->rbt_.Release_(node);
+	node->color_ = RedBlackTreeNode::black;
+	return node;
+}
+
+template<typename T, typename FullComparer>
+typename Set<T, FullComparer>::NodeHandle
+Set<T, FullComparer>::Extract(const Iterator& iter) {
+	PHI__debug_if(this != iter.set_) { PHI__throw("iter error"); }
+	if (iter.node_ == nullptr) { return NodeHandle(); }
+	return NodeHandle(this->Extract_(iter.node_));
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+typename Set<T, FullComparer>::NodeHandle
+Set<T, FullComparer>::FindExtract(const Index& index) {
+	Node* node(static_cast<Node*>(this->rbt_.Find_(index)));
+	if (node == nullptr) { return NodeHandle(); }
+	return NodeHandle(this->Extract_(node));
+}
+
+/*
+ * Inserts the node held by node_handle without copying its value.
+ * If an equal element already exists, node_handle keeps its node.
+*/
+template<typename T, typename FullComparer>
+pair<typename Set<T, FullComparer>::Iterator, bool>
+Set<T, FullComparer>::InsertNode(NodeHandle&& node_handle) {
+	if (node_handle.node_ == nullptr) {
+		return pair<Iterator, bool>(Iterator(this, nullptr), false);
+	}
+
+	Node* node(node_handle.node_);
+	Node* n(static_cast<Node*>(this->rbt_.Insert(node)));
+
+	if (node == n) { node_handle.node_ = nullptr; }
+
+	return pair<Iterator, bool>(Iterator(this, n), node == n);
+}
+
+/*
+ * Moves the nodes of set whose values are not in this set into this set.
+ * The values are not copied, the remaining nodes stay in set.
+*/
+template<typename T, typename FullComparer>
+void Set<T, FullComparer>::Merge(Set& set) {
+	if (this == &set) { return; }
+
+	Node* node(set.first_node_());
+
+	while (node != nullptr) {
+		Node* next_node(static_cast<Node*>(node->next()));
+
+		if (!this->rbt_.Contain(node->value)) {
+			this->rbt_.Insert_(set.Extract_(node));
+		}
+
+		node = next_node;
+	}
+}
+
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
@@ -887,6 +1033,57 @@ Set<T, FullComparer>::ConstIterator::operator--() {
 	return *this;
 }
 
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+Set<T, FullComparer>::NodeHandle::NodeHandle(): node_(nullptr) {}
+
+template<typename T, typename FullComparer>
+Set<T, FullComparer>::NodeHandle::NodeHandle(Node* node): node_(node) {}
+
+template<typename T, typename FullComparer>
+Set<T, FullComparer>::NodeHandle::NodeHandle(NodeHandle&& node_handle):
+	node_(node_handle.node_) {
+	node_handle.node_ = nullptr;
+}
+
+template<typename T, typename FullComparer>
+Set<T, FullComparer>::NodeHandle::~NodeHandle() {
+	if (this->node_ == nullptr) { return; }
+	this->node_->value.~T();
+	Free(this->node_);
+	this->node_ = nullptr;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+typename Set<T, FullComparer>::NodeHandle&
+Set<T, FullComparer>::NodeHandle::operator=(NodeHandle&& node_handle) {
+	if (this == &node_handle) { return *this; }
+
+	this->~NodeHandle();
+	this->node_ = node_handle.node_;
+	node_handle.node_ = nullptr;
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+bool Set<T, FullComparer>::NodeHandle::empty() const {
+	return this->node_ == nullptr;
+}
+
+template<typename T, typename FullComparer>
+T& Set<T, FullComparer>::NodeHandle::value() const {
+	PHI__debug_if(this->node_ == nullptr) { PHI__throw("node handle error"); }
+	return this->node_->value;
+}
+
 }
 }
 
@@ -0,0 +1,243 @@
+#ifndef PHI__define_guard__Container__ShardedLRUCache_h
+#define PHI__define_guard__Container__ShardedLRUCache_h
+
+#include <mutex>
+
+#include "LRUCache.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+ShardedLRUCache splits the keys over shard_num independent LRUCaches by hash,
+each guarded by its own mutex, so threads touching different shards do not
+contend. The bounds are divided between the shards, the first value % shard_num
+shards taking one more, so the shards never hold more than the bounds in
+total. shard_num is lowered to max_size or max_cost if either is smaller, so
+every shard can hold an entry. Recency is only tracked within a shard.
+
+Get copies the value out, a pointer into a shard would not be protected after
+the lock is released.
+*/
+
+template<typename Key, typename Value, typename Hasher = DefaultHasher,
+		 typename EqualComparer = DefaultEqualComparer>
+class ShardedLRUCache {
+public:
+	size_t size() const;
+	size_t cost() const;
+
+	size_t shard_num() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	ShardedLRUCache(size_t shard_num, size_t max_size,
+					size_t max_cost = size_t(-1), size_t max_protected_size = 0,
+					const Hasher& hasher = Hasher(),
+					const EqualComparer& eq_cmper = EqualComparer());
+
+	ShardedLRUCache(const ShardedLRUCache& cache) = delete;
+
+	~ShardedLRUCache();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	ShardedLRUCache& operator=(const ShardedLRUCache& cache) = delete;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool Contain(const Key& key) const;
+
+	bool Get(const Key& key, Value& dst);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename V> bool Put(const Key& key, V&& value, size_t cost = 1);
+
+	bool Erase(const Key& key);
+
+	void Clear();
+
+private:
+	struct Shard_ {
+		mutable std::mutex mutex;
+		LRUCache<Key, Value, Hasher, EqualComparer> cache;
+
+		Shard_(size_t max_size, size_t max_cost, size_t max_protected_size,
+			   const Hasher& hasher, const EqualComparer& eq_cmper);
+	};
+
+	size_t shard_num_;
+	Shard_* shards_;
+
+	Hasher hasher_;
+
+	Shard_& shard_(const Key& key) const;
+
+	static size_t ShardNum_(size_t shard_num, size_t max_size,
+							size_t max_cost);
+	static size_t Split_(size_t value, size_t shard_num, size_t i);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Shard_::Shard_(
+	size_t max_size, size_t max_cost, size_t max_protected_size,
+	const Hasher& hasher, const EqualComparer& eq_cmper):
+	cache(max_size, max_cost, max_protected_size, hasher, eq_cmper) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t ShardedLRUCache<Key, Value, Hasher, EqualComparer>::size() const {
+	size_t r(0);
+
+	for (size_t i(0); i != this->shard_num_; ++i) {
+		std::lock_guard<std::mutex> lock(this->shards_[i].mutex);
+		r += this->shards_[i].cache.size();
+	}
+
+	return r;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t ShardedLRUCache<Key, Value, Hasher, EqualComparer>::cost() const {
+	size_t r(0);
+
+	for (size_t i(0); i != this->shard_num_; ++i) {
+		std::lock_guard<std::mutex> lock(this->shards_[i].mutex);
+		r += this->shards_[i].cache.cost();
+	}
+
+	return r;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t ShardedLRUCache<Key, Value, Hasher, EqualComparer>::shard_num() const {
+	return this->shard_num_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+ShardedLRUCache<Key, Value, Hasher, EqualComparer>::ShardedLRUCache(
+	size_t shard_num, size_t max_size, size_t max_cost,
+	size_t max_protected_size, const Hasher& hasher,
+	const EqualComparer& eq_cmper):
+	shard_num_(ShardNum_(shard_num, max_size, max_cost)),
+	shards_(Malloc<Shard_>(this->shard_num_)), hasher_(hasher) {
+	PHI__debug_if(shard_num == 0) { PHI__throw("shard_num error"); }
+
+	for (size_t i(0); i != this->shard_num_; ++i) {
+		new (this->shards_ + i) Shard_(
+			Split_(max_size, this->shard_num_, i),
+			Split_(max_cost, this->shard_num_, i),
+			Split_(max_protected_size, this->shard_num_, i), hasher, eq_cmper);
+	}
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+ShardedLRUCache<Key, Value, Hasher, EqualComparer>::~ShardedLRUCache() {
+	Delete(this->shard_num_, this->shards_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Returns shard_num lowered so that every shard can hold at least one entry
+ * of cost 1, but at least 1.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t ShardedLRUCache<Key, Value, Hasher, EqualComparer>::ShardNum_(
+	size_t shard_num, size_t max_size, size_t max_cost) {
+	if (max_size < shard_num) { shard_num = max_size; }
+	if (max_cost < shard_num) { shard_num = max_cost; }
+	return shard_num == 0 ? 1 : shard_num;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+size_t ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Split_(
+	size_t value, size_t shard_num, size_t i) {
+	if (value == size_t(-1)) { return value; } // unbounded
+	return value / shard_num + (i < value % shard_num);
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+typename ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Shard_&
+ShardedLRUCache<Key, Value, Hasher, EqualComparer>::shard_(
+	const Key& key) const {
+	// mix the hash first, the shards would otherwise see correlated buckets
+	size_t h(size_t(this->hasher_(key)) * size_t(0x9e3779b97f4a7c15));
+	return this->shards_[(h >> 32) % this->shard_num_];
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Contain(
+	const Key& key) const {
+	Shard_& shard(this->shard_(key));
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return shard.cache.Contain(key);
+}
+
+/*
+ * Copies the value of key to dst and marks it as most recently used in its
+ * shard. Returns false if key is not cached.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Get(const Key& key,
+															 Value& dst) {
+	Shard_& shard(this->shard_(key));
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	Value* value(shard.cache.Get(key));
+	if (value == nullptr) { return false; }
+
+	dst = *value;
+
+	return true;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Returns false if the entry alone exceeds the bounds of its shard.
+*/
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+template<typename V>
+bool ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Put(const Key& key,
+															 V&& value,
+															 size_t cost) {
+	Shard_& shard(this->shard_(key));
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return shard.cache.Put(key, Forward<V>(value), cost) != nullptr;
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+bool ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Erase(const Key& key) {
+	Shard_& shard(this->shard_(key));
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return shard.cache.Erase(key);
+}
+
+template<typename Key, typename Value, typename Hasher, typename EqualComparer>
+void ShardedLRUCache<Key, Value, Hasher, EqualComparer>::Clear() {
+	for (size_t i(0); i != this->shard_num_; ++i) {
+		std::lock_guard<std::mutex> lock(this->shards_[i].mutex);
+		this->shards_[i].cache.Clear();
+	}
+}
+
+}
+}
+
+#endif
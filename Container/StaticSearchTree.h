@@ -0,0 +1,261 @@
+#ifndef PHI__define_guard__Container__StaticSearchTree_h
+#define PHI__define_guard__Container__StaticSearchTree_h
+
+#include "../Utility/memory_op.h"
+#include "../Utility/compare.h"
+#include "../Utility/search.h"
+#include "Vector.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+StaticSearchTree stores an immutable sorted sequence in Eytzinger (BFS) order,
+data_[1] is the root and the children of data_[k] are data_[2k] and
+data_[2k + 1]. The first levels of the tree share a few cache lines and every
+descent step only depends on one comparison, so LowerBound is branchless and
+can prefetch the grandchildren several levels ahead.
+*/
+
+template<typename T, typename FullComparer = DefaultFullComparer>
+class StaticSearchTree {
+public:
+	size_t size() const;
+	bool empty() const;
+
+	const FullComparer& full_cmper() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	StaticSearchTree(const FullComparer& full_cmper = FullComparer());
+
+	template<typename ForwardIterator>
+	StaticSearchTree(ForwardIterator begin, ForwardIterator end,
+					 const FullComparer& full_cmper = FullComparer());
+
+	StaticSearchTree(const Vector<T>& vector,
+					 const FullComparer& full_cmper = FullComparer());
+
+	StaticSearchTree(const StaticSearchTree& sst);
+	StaticSearchTree(StaticSearchTree&& sst);
+
+	~StaticSearchTree();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	StaticSearchTree& operator=(const StaticSearchTree& sst);
+	StaticSearchTree& operator=(StaticSearchTree&& sst);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename Index> bool Contain(const Index& index) const;
+
+	template<typename Index> const T* LowerBound(const Index& index) const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	void Clear();
+
+private:
+	static constexpr size_t prefetch_stride_ =
+		sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+
+	size_t size_;
+	T* data_;
+
+	FullComparer full_cmper_;
+
+	template<typename ForwardIterator>
+	void Build_(size_t k, ForwardIterator& iter);
+
+	void Copy_(const StaticSearchTree& sst);
+
+	static size_t trailing_ones_(size_t k);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+size_t StaticSearchTree<T, FullComparer>::size() const {
+	return this->size_;
+}
+
+template<typename T, typename FullComparer>
+bool StaticSearchTree<T, FullComparer>::empty() const {
+	return this->size_ == 0;
+}
+
+template<typename T, typename FullComparer>
+const FullComparer& StaticSearchTree<T, FullComparer>::full_cmper() const {
+	return this->full_cmper_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+StaticSearchTree<T, FullComparer>::StaticSearchTree(
+	const FullComparer& full_cmper):
+	size_(0),
+	data_(nullptr), full_cmper_(full_cmper) {}
+
+/*
+ * [begin, end) should be sorted by full_cmper.
+*/
+template<typename T, typename FullComparer>
+template<typename ForwardIterator>
+StaticSearchTree<T, FullComparer>::StaticSearchTree(
+	ForwardIterator begin, ForwardIterator end, const FullComparer& full_cmper):
+	size_(Distance(begin, end)),
+	data_(this->size_ == 0 ? nullptr : Malloc<T>(this->size_ + 1)),
+	full_cmper_(full_cmper) {
+	this->Build_(1, begin);
+}
+
+template<typename T, typename FullComparer>
+StaticSearchTree<T, FullComparer>::StaticSearchTree(
+	const Vector<T>& vector, const FullComparer& full_cmper):
+	StaticSearchTree(vector.data(), vector.data() + vector.size(),
+					 full_cmper) {}
+
+template<typename T, typename FullComparer>
+StaticSearchTree<T, FullComparer>::StaticSearchTree(
+	const StaticSearchTree& sst):
+	size_(0),
+	data_(nullptr), full_cmper_(sst.full_cmper_) {
+	this->Copy_(sst);
+}
+
+template<typename T, typename FullComparer>
+StaticSearchTree<T, FullComparer>::StaticSearchTree(StaticSearchTree&& sst):
+	size_(sst.size_), data_(sst.data_), full_cmper_(Move(sst.full_cmper_)) {
+	sst.size_ = 0;
+	sst.data_ = nullptr;
+}
+
+template<typename T, typename FullComparer>
+StaticSearchTree<T, FullComparer>::~StaticSearchTree() {
+	this->Clear();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+StaticSearchTree<T, FullComparer>&
+StaticSearchTree<T, FullComparer>::operator=(const StaticSearchTree& sst) {
+	if (this == &sst) { return *this; }
+
+	this->Clear();
+	this->full_cmper_ = sst.full_cmper_;
+	this->Copy_(sst);
+
+	return *this;
+}
+
+template<typename T, typename FullComparer>
+StaticSearchTree<T, FullComparer>&
+StaticSearchTree<T, FullComparer>::operator=(StaticSearchTree&& sst) {
+	if (this == &sst) { return *this; }
+
+	this->Clear();
+
+	this->size_ = sst.size_;
+	this->data_ = sst.data_;
+	this->full_cmper_ = Move(sst.full_cmper_);
+
+	sst.size_ = 0;
+	sst.data_ = nullptr;
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+template<typename ForwardIterator>
+void StaticSearchTree<T, FullComparer>::Build_(size_t k,
+											   ForwardIterator& iter) {
+	if (this->size_ < k) { return; }
+
+	this->Build_(2 * k, iter);
+	new (this->data_ + k) T(*iter);
+	++iter;
+	this->Build_(2 * k + 1, iter);
+}
+
+template<typename T, typename FullComparer>
+void StaticSearchTree<T, FullComparer>::Copy_(const StaticSearchTree& sst) {
+	if (sst.size_ == 0) { return; }
+
+	this->size_ = sst.size_;
+	this->data_ = Malloc<T>(this->size_ + 1);
+
+	for (size_t k(1); k <= this->size_; ++k) {
+		new (this->data_ + k) T(sst.data_[k]);
+	}
+}
+
+template<typename T, typename FullComparer>
+size_t StaticSearchTree<T, FullComparer>::trailing_ones_(size_t k) {
+#if (defined(__GNUC__) || defined(__GNUG__)) && true
+	return __builtin_ctzll(~(unsigned long long int)(k));
+#else
+	size_t r(0);
+	for (; k & 1; k >>= 1) { ++r; }
+	return r;
+#endif
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Returns the first element which is not less than index, or nullptr if there
+ * is no such element.
+ * The descent goes right whenever data_[k] < index, so the answer is the last
+ * node where it went left, which is k with its trailing right turns (1 bits)
+ * and the last left turn shifted out.
+*/
+template<typename T, typename FullComparer>
+template<typename Index>
+const T* StaticSearchTree<T, FullComparer>::LowerBound(
+	const Index& index) const {
+	size_t k(1);
+
+	while (k <= this->size_) {
+#if (defined(__GNUC__) || defined(__GNUG__)) && true
+		__builtin_prefetch(this->data_ + k * prefetch_stride_);
+#endif
+		k = 2 * k + (this->full_cmper_(this->data_[k], index) == -1);
+	}
+
+	k >>= trailing_ones_(k) + 1;
+
+	return k == 0 ? nullptr : this->data_ + k;
+}
+
+template<typename T, typename FullComparer>
+template<typename Index>
+bool StaticSearchTree<T, FullComparer>::Contain(const Index& index) const {
+	const T* r(this->LowerBound(index));
+	return r != nullptr && this->full_cmper_(*r, index) == 0;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename FullComparer>
+void StaticSearchTree<T, FullComparer>::Clear() {
+	for (size_t k(1); k <= this->size_; ++k) { this->data_[k].~T(); }
+	Free(this->data_);
+
+	this->size_ = 0;
+	this->data_ = nullptr;
+}
+
+}
+}
+
+#endif
@@ -70,7 +70,7 @@ struct TreeNode {
 
 #///////////////////////////////////////////////////////////////////////////////
 
-#if PHI__debug
+#if PHI__debug_flag
 	inline void Check() const;
 #endif
 
@@ -371,7 +371,7 @@ TreeNode* TreeNode::EndRelease() {
 
 #///////////////////////////////////////////////////////////////////////////////
 
-#if PHI__debug
+#if PHI__debug_flag
 
 void TreeNode::Check() const {
 	if (this->p_ != nullptr) {
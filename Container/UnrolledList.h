@@ -0,0 +1,876 @@
+#ifndef PHI__define_guard__Container__UnrolledList_h
+#define PHI__define_guard__Container__UnrolledList_h
+
+#include "../Utility/memory_op.h"
+#include "DoublyNode.h"
+#include "Pool.h"
+
+namespace phi {
+namespace cntr {
+
+/*
+UnrolledList stores up to K elements per node. The elements of a node occupy
+the slots [begin_, end_) of an inline array, so PushFront grows a node
+downward, PushBack grows it upward and iterating inside a node is a pointer
+increment.
+
+Insert and Erase shift the shorter side of one node, a full node is split in
+half and a node which drops to K / 2 elements together with its neighbour is
+merged into it. Splicing links whole nodes and splits at most one node.
+
+Insert, Erase and Splice invalidate iterators into the nodes they touch.
+*/
+
+template<typename T, size_t K = (sizeof(T) <= 128 ? 256 / sizeof(T) : 2)>
+class UnrolledList {
+	static_assert(2 <= K, "K too small");
+
+private:
+	struct LinkNode_: public DoublyNode {
+		using DoublyNode::PushPrevAllExcept;
+		using DoublyNode::PushNextAllExcept;
+	};
+
+	struct Node_: public LinkNode_ {
+		size_t begin_;
+		size_t end_;
+
+		alignas(T) unsigned char data_[sizeof(T) * K];
+
+		Node_(size_t begin);
+
+		size_t size() const;
+
+		T* at(size_t index);
+		const T* at(size_t index) const;
+	};
+
+public:
+	class Iterator;
+	class ConstIterator;
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	class Iterator {
+		friend class UnrolledList;
+
+	public:
+		Iterator(const Iterator& iter);
+
+		Iterator& operator=(const Iterator& iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		T& operator*() const;
+		T* operator->() const;
+
+		Iterator& operator++();
+		Iterator& operator--();
+
+	private:
+		UnrolledList* list_;
+		DoublyNode* node_;
+		size_t index_;
+
+		Iterator(UnrolledList* list, DoublyNode* node, size_t index);
+	};
+
+	class ConstIterator {
+		friend class UnrolledList;
+
+	public:
+		ConstIterator(const Iterator& iter);
+		ConstIterator(const ConstIterator& const_iter);
+
+		ConstIterator& operator=(const Iterator& iter);
+		ConstIterator& operator=(const ConstIterator& const_iter);
+
+		bool operator==(const Iterator& iter) const;
+		bool operator!=(const Iterator& iter) const;
+		bool operator==(const ConstIterator& const_iter) const;
+		bool operator!=(const ConstIterator& const_iter) const;
+
+		const T& operator*() const;
+		const T* operator->() const;
+
+		ConstIterator& operator++();
+		ConstIterator& operator--();
+
+	private:
+		const UnrolledList* list_;
+		const DoublyNode* node_;
+		size_t index_;
+
+		ConstIterator(const UnrolledList* list, const DoublyNode* node,
+					  size_t index);
+	};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const;
+	bool empty() const;
+
+	Iterator first_iterator();
+	Iterator last_iterator();
+	Iterator null_iterator();
+
+	ConstIterator first_iterator() const;
+	ConstIterator last_iterator() const;
+	ConstIterator null_iterator() const;
+
+	ConstIterator first_const_iterator() const;
+	ConstIterator last_const_iterator() const;
+	ConstIterator null_const_iterator() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	UnrolledList();
+	UnrolledList(const UnrolledList& list);
+	UnrolledList(UnrolledList&& list);
+
+	~UnrolledList();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	UnrolledList& operator=(const UnrolledList& list);
+	UnrolledList& operator=(UnrolledList&& list);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	T& front();
+	const T& front() const;
+
+	T& back();
+	const T& back() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename... Args> UnrolledList& PushFront(Args&&... args);
+	template<typename... Args> UnrolledList& PushBack(Args&&... args);
+
+	template<typename... Args>
+	Iterator Insert(const Iterator& iter, Args&&... args);
+
+	UnrolledList& PushListFront(UnrolledList& list);
+	UnrolledList& PushListBack(UnrolledList& list);
+
+	UnrolledList& Splice(const Iterator& iter, UnrolledList& list);
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	UnrolledList& PopFront();
+	UnrolledList& PopBack();
+	UnrolledList& Pop(const Iterator& iter);
+
+	Iterator Erase(const Iterator& iter);
+
+	void Clear();
+
+private:
+	size_t size_;
+	LinkNode_ node_;
+	UncountedPool<sizeof(Node_)> pool_;
+
+	Node_* New_(size_t begin);
+	void Release_(Node_* node);
+
+	Iterator MakeIterator_(Node_* node, size_t rank);
+
+	void Split_(Node_* node, size_t index);
+	void Merge_(Node_* x, Node_* y);
+
+	void Copy_(const UnrolledList& list);
+
+	static void Relocate_(T* dst, T* src, size_t size);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+UnrolledList<T, K>::Node_::Node_(size_t begin): begin_(begin), end_(begin) {}
+
+template<typename T, size_t K> size_t UnrolledList<T, K>::Node_::size() const {
+	return this->end_ - this->begin_;
+}
+
+template<typename T, size_t K> T* UnrolledList<T, K>::Node_::at(size_t index) {
+	return reinterpret_cast<T*>(this->data_) + index;
+}
+
+template<typename T, size_t K>
+const T* UnrolledList<T, K>::Node_::at(size_t index) const {
+	return reinterpret_cast<const T*>(this->data_) + index;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K> size_t UnrolledList<T, K>::size() const {
+	return this->size_;
+}
+
+template<typename T, size_t K> bool UnrolledList<T, K>::empty() const {
+	return this->size_ == 0;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator UnrolledList<T, K>::first_iterator() {
+	return ++this->null_iterator();
+}
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator UnrolledList<T, K>::last_iterator() {
+	return --this->null_iterator();
+}
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator UnrolledList<T, K>::null_iterator() {
+	return Iterator(this, &this->node_, 0);
+}
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator
+UnrolledList<T, K>::first_iterator() const {
+	return ++this->null_const_iterator();
+}
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator
+UnrolledList<T, K>::last_iterator() const {
+	return --this->null_const_iterator();
+}
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator
+UnrolledList<T, K>::null_iterator() const {
+	return ConstIterator(this, &this->node_, 0);
+}
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator
+UnrolledList<T, K>::first_const_iterator() const {
+	return ++this->null_const_iterator();
+}
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator
+UnrolledList<T, K>::last_const_iterator() const {
+	return --this->null_const_iterator();
+}
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator
+UnrolledList<T, K>::null_const_iterator() const {
+	return ConstIterator(this, &this->node_, 0);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K> UnrolledList<T, K>::UnrolledList(): size_(0) {}
+
+template<typename T, size_t K>
+UnrolledList<T, K>::UnrolledList(const UnrolledList& list): size_(0) {
+	this->Copy_(list);
+}
+
+template<typename T, size_t K>
+UnrolledList<T, K>::UnrolledList(UnrolledList&& list): size_(list.size_) {
+	list.size_ = 0;
+	this->node_.PushPrevAllExcept(&list.node_);
+}
+
+template<typename T, size_t K> UnrolledList<T, K>::~UnrolledList() {
+	this->Clear();
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::operator=(const UnrolledList& list) {
+	if (this == &list) { return *this; }
+
+	this->Clear();
+	this->Copy_(list);
+
+	return *this;
+}
+
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::operator=(UnrolledList&& list) {
+	if (this == &list) { return *this; }
+
+	this->Clear();
+
+	this->size_ = list.size_;
+	list.size_ = 0;
+	this->node_.PushPrevAllExcept(&list.node_);
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K> T& UnrolledList<T, K>::front() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	Node_* node(static_cast<Node_*>(this->node_.next()));
+	return *node->at(node->begin_);
+}
+
+template<typename T, size_t K> const T& UnrolledList<T, K>::front() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	const Node_* node(static_cast<const Node_*>(this->node_.next()));
+	return *node->at(node->begin_);
+}
+
+template<typename T, size_t K> T& UnrolledList<T, K>::back() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	Node_* node(static_cast<Node_*>(this->node_.prev()));
+	return *node->at(node->end_ - 1);
+}
+
+template<typename T, size_t K> const T& UnrolledList<T, K>::back() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("index error"); }
+	const Node_* node(static_cast<const Node_*>(this->node_.prev()));
+	return *node->at(node->end_ - 1);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Node_* UnrolledList<T, K>::New_(size_t begin) {
+	return new (this->pool_.Pop()) Node_(begin);
+}
+
+template<typename T, size_t K>
+void UnrolledList<T, K>::Release_(Node_* node) {
+	this->pool_.Push(node->Pop());
+}
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator
+UnrolledList<T, K>::MakeIterator_(Node_* node, size_t rank) {
+	if (rank != node->size()) {
+		return Iterator(this, node, node->begin_ + rank);
+	}
+
+	DoublyNode* next(node->next());
+
+	return Iterator(this, next,
+					next == &this->node_ ? 0 : static_cast<Node_*>(next)->begin_);
+}
+
+/*
+ * Moves the elements in [index, end_) of node to a new node linked after it.
+*/
+template<typename T, size_t K>
+void UnrolledList<T, K>::Split_(Node_* node, size_t index) {
+	Node_* m(this->New_(0));
+	node->PushNext(m);
+
+	m->end_ = node->end_ - index;
+	Relocate_(m->at(0), node->at(index), m->end_);
+	node->end_ = index;
+}
+
+/*
+ * Appends the elements of y, the node after x, to x and releases y.
+*/
+template<typename T, size_t K>
+void UnrolledList<T, K>::Merge_(Node_* x, Node_* y) {
+	size_t x_size(x->size());
+
+	Relocate_(x->at(0), x->at(x->begin_), x_size);
+	Relocate_(x->at(x_size), y->at(y->begin_), y->size());
+
+	x->begin_ = 0;
+	x->end_ = x_size + y->size();
+
+	this->Release_(y);
+}
+
+template<typename T, size_t K>
+void UnrolledList<T, K>::Copy_(const UnrolledList& list) {
+	for (const DoublyNode* i(list.node_.next()); i != &list.node_;
+		 i = i->next()) {
+		const Node_* src(static_cast<const Node_*>(i));
+		Node_* dst(this->New_(src->begin_));
+		this->node_.PushPrev(dst);
+
+		for (; dst->end_ != src->end_; ++dst->end_) {
+			new (dst->at(dst->end_)) T(*src->at(dst->end_));
+		}
+	}
+
+	this->size_ = list.size_;
+}
+
+/*
+ * Move-constructs src[0, size) into dst[0, size) and destroys the sources. The
+ * ranges may overlap.
+*/
+template<typename T, size_t K>
+void UnrolledList<T, K>::Relocate_(T* dst, T* src, size_t size) {
+	if (dst < src) {
+		for (size_t i(0); i != size; ++i) {
+			new (dst + i) T(Move(src[i]));
+			src[i].~T();
+		}
+	} else if (src < dst) {
+		for (size_t i(size); i != 0; --i) {
+			new (dst + i - 1) T(Move(src[i - 1]));
+			src[i - 1].~T();
+		}
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+template<typename... Args>
+UnrolledList<T, K>& UnrolledList<T, K>::PushFront(Args&&... args) {
+	Node_* node;
+
+	if (this->size_ == 0 ||
+		static_cast<Node_*>(this->node_.next())->begin_ == 0) {
+		node = this->New_(K);
+		this->node_.PushNext(node);
+	} else {
+		node = static_cast<Node_*>(this->node_.next());
+	}
+
+	new (node->at(node->begin_ - 1)) T(Forward<Args>(args)...);
+	--node->begin_;
+	++this->size_;
+
+	return *this;
+}
+
+template<typename T, size_t K>
+template<typename... Args>
+UnrolledList<T, K>& UnrolledList<T, K>::PushBack(Args&&... args) {
+	Node_* node;
+
+	if (this->size_ == 0 || static_cast<Node_*>(this->node_.prev())->end_ == K) {
+		node = this->New_(0);
+		this->node_.PushPrev(node);
+	} else {
+		node = static_cast<Node_*>(this->node_.prev());
+	}
+
+	new (node->at(node->end_)) T(Forward<Args>(args)...);
+	++node->end_;
+	++this->size_;
+
+	return *this;
+}
+
+/*
+ * Inserts a new element before iter and returns the iterator to it.
+*/
+template<typename T, size_t K>
+template<typename... Args>
+typename UnrolledList<T, K>::Iterator
+UnrolledList<T, K>::Insert(const Iterator& iter, Args&&... args) {
+	PHI__debug_if(this != iter.list_) { PHI__throw("iter error"); }
+
+	if (iter.node_ == &this->node_) {
+		this->PushBack(Forward<Args>(args)...);
+		return this->last_iterator();
+	}
+
+	Node_* node(static_cast<Node_*>(iter.node_));
+	size_t index(iter.index_);
+
+	if (index == node->begin_ && node->prev() != &this->node_ &&
+		static_cast<Node_*>(node->prev())->end_ != K) {
+		node = static_cast<Node_*>(node->prev());
+		index = node->end_;
+	} else if (node->size() == K) {
+		size_t mid(K / 2);
+		this->Split_(node, mid);
+
+		if (mid < index) {
+			node = static_cast<Node_*>(node->next());
+			index -= mid;
+		}
+	}
+
+	if (node->end_ != K &&
+		(node->begin_ == 0 || node->end_ - index <= index - node->begin_)) {
+		Relocate_(node->at(index + 1), node->at(index), node->end_ - index);
+		++node->end_;
+	} else {
+		Relocate_(node->at(node->begin_ - 1), node->at(node->begin_),
+				  index - node->begin_);
+		--node->begin_;
+		--index;
+	}
+
+	new (node->at(index)) T(Forward<Args>(args)...);
+	++this->size_;
+
+	return Iterator(this, node, index);
+}
+
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::PushListFront(UnrolledList& list) {
+	if (this == &list) { return *this; }
+	this->size_ += list.size_;
+	list.size_ = 0;
+	this->node_.PushNextAllExcept(&list.node_);
+	return *this;
+}
+
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::PushListBack(UnrolledList& list) {
+	if (this == &list) { return *this; }
+	this->size_ += list.size_;
+	list.size_ = 0;
+	this->node_.PushPrevAllExcept(&list.node_);
+	return *this;
+}
+
+/*
+ * Moves all elements of list before iter. Only the node iter points into is
+ * split, the nodes of list are linked as they are.
+*/
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::Splice(const Iterator& iter,
+											   UnrolledList& list) {
+	PHI__debug_if(this != iter.list_ || this == &list) {
+		PHI__throw("iter error");
+	}
+
+	if (list.size_ == 0) { return *this; }
+
+	LinkNode_* pos(static_cast<LinkNode_*>(iter.node_));
+
+	if (pos != &this->node_) {
+		Node_* node(static_cast<Node_*>(iter.node_));
+
+		if (iter.index_ != node->begin_) {
+			this->Split_(node, iter.index_);
+			pos = static_cast<LinkNode_*>(node->next());
+		}
+	}
+
+	this->size_ += list.size_;
+	list.size_ = 0;
+	pos->PushPrevAllExcept(&list.node_);
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::PopFront() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("size error"); }
+
+	Node_* node(static_cast<Node_*>(this->node_.next()));
+	node->at(node->begin_)->~T();
+	--this->size_;
+
+	if (++node->begin_ == node->end_) { this->Release_(node); }
+
+	return *this;
+}
+
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::PopBack() {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("size error"); }
+
+	Node_* node(static_cast<Node_*>(this->node_.prev()));
+	node->at(node->end_ - 1)->~T();
+	--this->size_;
+
+	if (node->begin_ == --node->end_) { this->Release_(node); }
+
+	return *this;
+}
+
+template<typename T, size_t K>
+UnrolledList<T, K>& UnrolledList<T, K>::Pop(const Iterator& iter) {
+	this->Erase(iter);
+	const_cast<Iterator&>(iter).node_ = nullptr;
+	return *this;
+}
+
+/*
+ * Erases the element at iter and returns the iterator to the element after it.
+*/
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator
+UnrolledList<T, K>::Erase(const Iterator& iter) {
+	PHI__debug_if(this != iter.list_ || iter.node_ == nullptr ||
+				  iter.node_ == &this->node_) {
+		PHI__throw("iter error");
+	}
+
+	Node_* node(static_cast<Node_*>(iter.node_));
+	size_t index(iter.index_);
+	size_t rank(index - node->begin_);
+
+	node->at(index)->~T();
+	--this->size_;
+
+	if (rank < node->end_ - 1 - index) {
+		Relocate_(node->at(node->begin_ + 1), node->at(node->begin_), rank);
+		++node->begin_;
+	} else {
+		Relocate_(node->at(index), node->at(index + 1),
+				  node->end_ - 1 - index);
+		--node->end_;
+	}
+
+	if (node->begin_ == node->end_) {
+		DoublyNode* next(node->next());
+		this->Release_(node);
+		return Iterator(this, next,
+						next == &this->node_ ?
+							0 : static_cast<Node_*>(next)->begin_);
+	}
+
+	if (node->prev() != &this->node_) {
+		Node_* prev(static_cast<Node_*>(node->prev()));
+
+		if (prev->size() + node->size() <= K / 2) {
+			rank += prev->size();
+			this->Merge_(prev, node);
+			node = prev;
+		}
+	}
+
+	if (node->next() != &this->node_) {
+		Node_* next(static_cast<Node_*>(node->next()));
+		if (node->size() + next->size() <= K / 2) { this->Merge_(node, next); }
+	}
+
+	return this->MakeIterator_(node, rank);
+}
+
+template<typename T, size_t K> void UnrolledList<T, K>::Clear() {
+	this->size_ = 0;
+
+	while (!this->node_.sole()) {
+		Node_* node(static_cast<Node_*>(this->node_.prev()));
+		for (size_t i(node->begin_); i != node->end_; ++i) {
+			node->at(i)->~T();
+		}
+		this->Release_(node);
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+UnrolledList<T, K>::Iterator::Iterator(const Iterator& iter):
+	list_(iter.list_), node_(iter.node_), index_(iter.index_) {}
+
+template<typename T, size_t K>
+UnrolledList<T, K>::Iterator::Iterator(UnrolledList* list, DoublyNode* node,
+									   size_t index):
+	list_(list),
+	node_(node), index_(index) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator&
+UnrolledList<T, K>::Iterator::operator=(const Iterator& iter) {
+	this->list_ = iter.list_;
+	this->node_ = iter.node_;
+	this->index_ = iter.index_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+bool UnrolledList<T, K>::Iterator::operator==(const Iterator& iter) const {
+	return this->node_ == iter.node_ && this->index_ == iter.index_ &&
+		   this->list_ == iter.list_;
+}
+template<typename T, size_t K>
+bool UnrolledList<T, K>::Iterator::operator!=(const Iterator& iter) const {
+	return !(*this == iter);
+}
+
+template<typename T, size_t K>
+bool UnrolledList<T, K>::Iterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->node_ == const_iter.node_ &&
+		   this->index_ == const_iter.index_ && this->list_ == const_iter.list_;
+}
+template<typename T, size_t K>
+bool UnrolledList<T, K>::Iterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return !(*this == const_iter);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K> T& UnrolledList<T, K>::Iterator::operator*() const {
+	return *static_cast<Node_*>(this->node_)->at(this->index_);
+}
+template<typename T, size_t K> T* UnrolledList<T, K>::Iterator::operator->() const {
+	return static_cast<Node_*>(this->node_)->at(this->index_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator&
+UnrolledList<T, K>::Iterator::operator++() {
+	if (this->node_ != &this->list_->node_ &&
+		++this->index_ != static_cast<Node_*>(this->node_)->end_) {
+		return *this;
+	}
+
+	this->node_ = this->node_->next();
+	this->index_ = this->node_ == &this->list_->node_ ?
+					   0 : static_cast<Node_*>(this->node_)->begin_;
+
+	return *this;
+}
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::Iterator&
+UnrolledList<T, K>::Iterator::operator--() {
+	if (this->node_ != &this->list_->node_ &&
+		this->index_ != static_cast<Node_*>(this->node_)->begin_) {
+		--this->index_;
+		return *this;
+	}
+
+	this->node_ = this->node_->prev();
+	this->index_ = this->node_ == &this->list_->node_ ?
+					   0 : static_cast<Node_*>(this->node_)->end_ - 1;
+
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+UnrolledList<T, K>::ConstIterator::ConstIterator(const Iterator& iter):
+	list_(iter.list_), node_(iter.node_), index_(iter.index_) {}
+
+template<typename T, size_t K>
+UnrolledList<T, K>::ConstIterator::ConstIterator(
+	const ConstIterator& const_iter):
+	list_(const_iter.list_),
+	node_(const_iter.node_), index_(const_iter.index_) {}
+
+template<typename T, size_t K>
+UnrolledList<T, K>::ConstIterator::ConstIterator(const UnrolledList* list,
+												 const DoublyNode* node,
+												 size_t index):
+	list_(list),
+	node_(node), index_(index) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator&
+UnrolledList<T, K>::ConstIterator::operator=(const Iterator& iter) {
+	this->list_ = iter.list_;
+	this->node_ = iter.node_;
+	this->index_ = iter.index_;
+	return *this;
+}
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator&
+UnrolledList<T, K>::ConstIterator::operator=(const ConstIterator& const_iter) {
+	this->list_ = const_iter.list_;
+	this->node_ = const_iter.node_;
+	this->index_ = const_iter.index_;
+	return *this;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+bool UnrolledList<T, K>::ConstIterator::operator==(const Iterator& iter) const {
+	return this->node_ == iter.node_ && this->index_ == iter.index_ &&
+		   this->list_ == iter.list_;
+}
+template<typename T, size_t K>
+bool UnrolledList<T, K>::ConstIterator::operator!=(const Iterator& iter) const {
+	return !(*this == iter);
+}
+
+template<typename T, size_t K>
+bool UnrolledList<T, K>::ConstIterator::operator==(
+	const ConstIterator& const_iter) const {
+	return this->node_ == const_iter.node_ &&
+		   this->index_ == const_iter.index_ && this->list_ == const_iter.list_;
+}
+template<typename T, size_t K>
+bool UnrolledList<T, K>::ConstIterator::operator!=(
+	const ConstIterator& const_iter) const {
+	return !(*this == const_iter);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+const T& UnrolledList<T, K>::ConstIterator::operator*() const {
+	return *static_cast<const Node_*>(this->node_)->at(this->index_);
+}
+template<typename T, size_t K>
+const T* UnrolledList<T, K>::ConstIterator::operator->() const {
+	return static_cast<const Node_*>(this->node_)->at(this->index_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator&
+UnrolledList<T, K>::ConstIterator::operator++() {
+	if (this->node_ != &this->list_->node_ &&
+		++this->index_ != static_cast<const Node_*>(this->node_)->end_) {
+		return *this;
+	}
+
+	this->node_ = this->node_->next();
+	this->index_ = this->node_ == &this->list_->node_ ?
+					   0 : static_cast<const Node_*>(this->node_)->begin_;
+
+	return *this;
+}
+
+template<typename T, size_t K>
+typename UnrolledList<T, K>::ConstIterator&
+UnrolledList<T, K>::ConstIterator::operator--() {
+	if (this->node_ != &this->list_->node_ &&
+		this->index_ != static_cast<const Node_*>(this->node_)->begin_) {
+		--this->index_;
+		return *this;
+	}
+
+	this->node_ = this->node_->prev();
+	this->index_ = this->node_ == &this->list_->node_ ?
+					   0 : static_cast<const Node_*>(this->node_)->end_ - 1;
+
+	return *this;
+}
+
+}
+}
+
+#endif
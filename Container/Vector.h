@@ -170,6 +170,9 @@ public:
 	T& at(size_t index);
 	const T& at(size_t index) const;
 
+	T* data();
+	const T* data() const;
+
 #///////////////////////////////////////////////////////////////////////////////
 
 	template<typename... Args> T& Push(Args&&... args);
@@ -449,6 +452,9 @@ template<typename T> const T& Vector<T>::at(size_t index) const {
 	return this->data_[index];
 }
 
+template<typename T> T* Vector<T>::data() { return this->data_; }
+template<typename T> const T* Vector<T>::data() const { return this->data_; }
+
 #///////////////////////////////////////////////////////////////////////////////
 
 template<typename T>
@@ -496,15 +502,15 @@ void Vector<T>::PushIterator(BidirectionalIterator begin,
 template<typename T>
 template<typename... Args>
 void Vector<T>::Insert(size_t index, Args&&... args) {
-	PHI__debug_if(!this->valid_(index)) { PHI__throw("index error"); }
+	PHI__debug_if(this->size_ < index) { PHI__throw("index error"); }
 
 	if (index == this->size_) {
-		this->PushBack(Forward<Args>(args)...);
-		return this->data_ + this->size_ - 1;
+		this->Push(Forward<Args>(args)...);
+		return;
 	}
 
 	if (this->size_ < this->capacity_) {
-		new (this->data_ + this->size_) T(Move(this->data_ + this->size_ - 1));
+		new (this->data_ + this->size_) T(Move(this->data_[this->size_ - 1]));
 
 		for (size_t i(this->size_ - 1); i != index; --i) {
 			this->data_[i] = Move(this->data_[i - 1]);
@@ -514,22 +520,19 @@ void Vector<T>::Insert(size_t index, Args&&... args) {
 		this->data_[index].~T();
 		new (this->data_ + index) T(Forward<Args>(args)...);
 
-		return this->data_ + index;
+		return;
 	}
 
-	T* data(
-		Malloc<T>(this->capacity_ = CapacityShouldAlloc(this->capacity_ + 1)));
+	T* data(Malloc<T>(this->capacity_ = CapacityShouldAlloc(this->size_ + 1)));
 
-	size_t i(0);
+	new (data + index) T(Forward<Args>(args)...);
 
-	for (; i != index; ++i) {
+	for (size_t i(0); i != index; ++i) {
 		new (data + i) T(Move(this->data_[i]));
 		this->data_[i].~T();
 	}
 
-	new (data + i) T(Forward<Args>(args)...);
-
-	for (; i != this->size_; ++i) {
+	for (size_t i(index); i != this->size_; ++i) {
 		new (data + i + 1) T(Move(this->data_[i]));
 		this->data_[i].~T();
 	}
@@ -537,8 +540,6 @@ void Vector<T>::Insert(size_t index, Args&&... args) {
 	++this->size_;
 	Free(this->data_);
 	this->data_ = data;
-
-	return this->data_ + index;
 }
 
 template<typename T>
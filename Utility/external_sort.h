@@ -0,0 +1,284 @@
+#ifndef PHI__define_guard__Utility__external_sort_h
+#define PHI__define_guard__Utility__external_sort_h
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include "sort4.h"
+#include "kway_merge.h"
+
+namespace phi {
+
+/*
+ExternalSort sorts a file of fixed-size Records that may be far larger than
+memory. Record is read and written as raw bytes, so it must be trivially
+copyable.
+
+The input is streamed through a buffer of memory_budget bytes. Each full
+buffer is sorted by Sort, or by ParallelSort if thread_num != 1, and written
+out as a run. The runs are then merged in passes of up to fan-in runs at a
+time through a loser tree. The same budget is split into one block per input
+run plus one output block, and fan-in is as large as the budget allows while
+every block keeps PHI__external_sort_min_block bytes. With 32 GB of memory that
+is one merge pass for any input below a few PB.
+
+Runs are written next to dst_path as dst_path.<pass>.<index> and are removed
+once merged. Returns false if memory_budget holds fewer than 3 Records, if the
+size of src_path is not a multiple of sizeof(Record) or if a file can not be
+opened, read or written. The runs of a failed merge are kept.
+*/
+
+#define PHI__external_sort_min_block (1 << 20)
+
+template<typename Record> struct ExternalSortRun_ {
+	FILE* file;
+	Record* block;
+	size_t block_capacity;
+	size_t size;
+	size_t index;
+};
+
+/*
+ * Refills the block of run from its file. Returns false if the file is
+ * exhausted.
+*/
+template<typename Record>
+bool ExternalSortFill_(ExternalSortRun_<Record>& run) {
+	run.size = std::fread(run.block, sizeof(Record), run.block_capacity,
+						  run.file);
+	run.index = 0;
+	return run.size != 0;
+}
+
+template<typename Record>
+bool ExternalSortWrite_(FILE* file, const Record* src, size_t size) {
+	return std::fwrite(src, sizeof(Record), size, file) == size;
+}
+
+/*
+ * Writes the name of run index of pass to dst, which holds at least
+ * strlen(path) + 64 chars.
+*/
+inline void ExternalSortRunPath_(char* dst, const char* path, size_t pass,
+								 size_t index) {
+	std::sprintf(dst, "%s.%zu.%zu", path, pass, index);
+}
+
+template<typename Record, typename LessThanComparer>
+struct ExternalSortRunBeats_ {
+	ExternalSortRun_<Record>* runs;
+	LessThanComparer& lt_cmper;
+
+	// exhausted runs lose every match
+	bool operator()(size_t x, size_t y) const {
+		if (this->runs[y].size == 0) { return true; }
+		if (this->runs[x].size == 0) { return false; }
+		return !this->lt_cmper.lt(this->runs[y].block[this->runs[y].index],
+								  this->runs[x].block[this->runs[x].index]);
+	}
+};
+
+/*
+ * Merges the sorted files srcs[0, src_num) into dst with memory of capacity
+ * Records.
+*/
+template<typename Record, typename LessThanComparer>
+bool ExternalSortMerge_(FILE** srcs, size_t src_num, FILE* dst, Record* memory,
+						size_t capacity, LessThanComparer& lt_cmper) {
+	size_t block_capacity(capacity / (src_num + 1));
+
+	ExternalSortRun_<Record>* runs(Malloc<ExternalSortRun_<Record>>(src_num));
+	size_t* losers(Malloc<size_t>(src_num));
+
+	for (size_t i(0); i != src_num; ++i) {
+		runs[i].file = srcs[i];
+		runs[i].block = memory + i * block_capacity;
+		runs[i].block_capacity = block_capacity;
+		ExternalSortFill_(runs[i]);
+	}
+
+	ExternalSortRunBeats_<Record, LessThanComparer> beats { runs, lt_cmper };
+
+	loser_tree::Make(losers, src_num, beats);
+
+	Record* out(memory + src_num * block_capacity);
+	size_t out_size(0);
+	bool ok(true);
+
+	for (;;) {
+		ExternalSortRun_<Record>& run(runs[losers[0]]);
+		if (run.size == 0) { break; }
+
+		out[out_size] = run.block[run.index];
+
+		if (++out_size == block_capacity) {
+			ok = ok && ExternalSortWrite_(dst, out, out_size);
+			out_size = 0;
+		}
+
+		if (++run.index == run.size) { ExternalSortFill_(run); }
+
+		loser_tree::Replay(losers, src_num, losers[0], beats);
+	}
+
+	ok = ok && ExternalSortWrite_(dst, out, out_size);
+
+	for (size_t i(0); i != src_num; ++i) {
+		ok = ok && !std::ferror(srcs[i]);
+	}
+
+	Free(losers);
+	Free(runs);
+
+	return ok;
+}
+
+/*
+ * Sorts the Records of the file src_path into the file dst_path, using about
+ * memory_budget bytes of memory. src_path and dst_path may be the same file.
+*/
+template<typename Record, typename LessThanComparer = DefaultLessThanComparer>
+bool ExternalSort(const char* src_path, const char* dst_path,
+				  size_t memory_budget,
+				  LessThanComparer&& lt_cmper = LessThanComparer(),
+				  size_t thread_num = 1) {
+	static_assert(std::is_trivially_copyable<Record>::value,
+				  "Record error");
+
+	size_t capacity(memory_budget / sizeof(Record));
+
+	// a merge needs a block of at least one Record per run plus the output
+	if (capacity < 3) { return false; }
+
+	size_t fan_in(memory_budget / PHI__external_sort_min_block);
+	fan_in = fan_in < 3 ? 2 : fan_in - 1;
+	if (capacity - 1 < fan_in) { fan_in = capacity - 1; }
+
+	Record* memory(Malloc<Record>(capacity));
+	char* out_path(Malloc<char>(std::strlen(dst_path) + 64));
+
+	bool ok(true);
+	size_t run_num(0);
+
+	FILE* src(std::fopen(src_path, "rb"));
+	ok = src != nullptr;
+
+	while (ok) {
+		// read bytes, a partial Record at the end would otherwise be dropped
+		size_t byte_size(
+			std::fread(memory, 1, capacity * sizeof(Record), src));
+		size_t size(byte_size / sizeof(Record));
+
+		if (byte_size % sizeof(Record) != 0) {
+			ok = false;
+			break;
+		}
+
+		if (size == 0) { break; }
+
+		if (thread_num == 1) {
+			Sort(memory, memory + size, lt_cmper);
+		} else {
+			ParallelSort(memory, memory + size, lt_cmper, thread_num);
+		}
+
+		ExternalSortRunPath_(out_path, dst_path, 0, run_num);
+		FILE* run(std::fopen(out_path, "wb"));
+		++run_num;
+
+		ok = run != nullptr && ExternalSortWrite_(run, memory, size);
+		if (run != nullptr) { ok = std::fclose(run) == 0 && ok; }
+
+		if (size < capacity) { break; }
+	}
+
+	if (src != nullptr) {
+		ok = ok && !std::ferror(src);
+		std::fclose(src);
+	}
+
+	if (!ok) {
+		for (size_t i(0); i != run_num; ++i) {
+			ExternalSortRunPath_(out_path, dst_path, 0, i);
+			std::remove(out_path);
+		}
+	}
+
+	if (ok && run_num == 0) {
+		FILE* dst(std::fopen(dst_path, "wb"));
+		ok = dst != nullptr && std::fclose(dst) == 0;
+	}
+
+	FILE** srcs(Malloc<FILE*>(fan_in));
+	char* in_path(Malloc<char>(std::strlen(dst_path) + 64));
+
+	for (size_t pass(0); ok && run_num != 0; ++pass) {
+		if (run_num == 1) {
+			ExternalSortRunPath_(out_path, dst_path, pass, 0);
+			std::remove(dst_path);
+			ok = std::rename(out_path, dst_path) == 0;
+			break;
+		}
+
+		size_t next_run_num(0);
+
+		for (size_t begin(0); ok && begin < run_num; begin += fan_in) {
+			size_t src_num(run_num - begin < fan_in ? run_num - begin : fan_in);
+
+			ExternalSortRunPath_(out_path, dst_path, pass + 1, next_run_num);
+			++next_run_num;
+
+			if (src_num == 1) {
+				ExternalSortRunPath_(in_path, dst_path, pass, begin);
+				ok = std::rename(in_path, out_path) == 0;
+				continue;
+			}
+
+			size_t opened(0);
+
+			for (; opened != src_num; ++opened) {
+				ExternalSortRunPath_(in_path, dst_path, pass, begin + opened);
+				srcs[opened] = std::fopen(in_path, "rb");
+				if (srcs[opened] == nullptr) { break; }
+			}
+
+			FILE* dst(opened == src_num ? std::fopen(out_path, "wb") : nullptr);
+			ok = dst != nullptr;
+
+			if (ok) {
+				ok = ExternalSortMerge_(srcs, src_num, dst, memory, capacity,
+										lt_cmper);
+			}
+
+			if (dst != nullptr) {
+				ok = std::fclose(dst) == 0 && ok;
+				if (!ok) { std::remove(out_path); }
+			}
+
+			for (size_t i(0); i != opened; ++i) {
+				std::fclose(srcs[i]);
+
+				if (ok) {
+					ExternalSortRunPath_(in_path, dst_path, pass, begin + i);
+					std::remove(in_path);
+				}
+			}
+		}
+
+		run_num = next_run_num;
+	}
+
+	Free(in_path);
+	Free(srcs);
+	Free(out_path);
+	Free(memory);
+
+	return ok;
+}
+
+#undef PHI__external_sort_min_block
+
+}
+
+#endif
@@ -3,20 +3,22 @@
 
 #include "../Container/List.h"
 #include "../Container/RedBlackTree.h"
+#include "../Container/IndexedPriorityQueue.h"
+#include "pair.h"
 
 namespace phi {
 
 namespace a_star_search_utility {
 
 struct PosOrder: public cntr::RedBlackTreeNode {};
-struct ScoreOrder: public cntr::RedBlackTreeNode {};
 
-template<typename Node> struct Agent: public PosOrder, public ScoreOrder {
+template<typename Node> struct Agent: public PosOrder {
 	Node* node;
 	Agent* parent;
 	size_t dist_to_parent;
 	size_t g_score;
 	size_t f_score;
+	size_t handle; // in the open queue
 };
 
 #///////////////////////////////////////////////////////////////////////////////
@@ -63,34 +65,27 @@ using PosComparer = AutoImplementFullComparer<PosComparer_<Node, NodeComparer>>;
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 
-template<typename Node, typename NodeComparer> struct ScoreComparer_ {
+/*
+ * The greater agent is the one to expand first, it has the smaller f_score,
+ * or the greater g_score for equal f_scores.
+*/
+template<typename Node, typename NodeComparer> struct ScoreLessThanComparer {
 	const NodeComparer& node_cmper;
 
 #///////////////////////////////////////////////////////////////////////////////
 
-	ScoreComparer_(const NodeComparer& node_cmper): node_cmper(node_cmper) {}
+	ScoreLessThanComparer(const NodeComparer& node_cmper):
+		node_cmper(node_cmper) {}
 
 #///////////////////////////////////////////////////////////////////////////////
 
-	inline int operator()(const cntr::RedBlackTreeNode* x,
-						  const cntr::RedBlackTreeNode* y) const {
-		const Agent<Node>* a(
-			static_cast<const Agent<Node>*>(static_cast<const ScoreOrder*>(x)));
-		const Agent<Node>* b(
-			static_cast<const Agent<Node>*>(static_cast<const ScoreOrder*>(y)));
-
-		if (a->f_score < b->f_score) { return -1; }
-		if (a->f_score > b->f_score) { return 1; }
-		if (a->g_score > b->g_score) { return -1; }
-		if (a->g_score < b->g_score) { return 1; }
-		return this->node_cmper(a->node, b->node);
+	inline bool lt(const Agent<Node>* a, const Agent<Node>* b) const {
+		if (a->f_score != b->f_score) { return a->f_score > b->f_score; }
+		if (a->g_score != b->g_score) { return a->g_score < b->g_score; }
+		return 0 < this->node_cmper(a->node, b->node);
 	}
 };
 
-template<typename Node, typename NodeComparer>
-using ScoreComparer =
-	AutoImplementFullComparer<ScoreComparer_<Node, NodeComparer>>;
-
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
@@ -114,37 +109,11 @@ public:
 	void Release(Agent<Node>* agent) {
 		this->RBT::Release(static_cast<PosOrder*>(agent));
 	}
-};
-
-#///////////////////////////////////////////////////////////////////////////////
-#///////////////////////////////////////////////////////////////////////////////
-#///////////////////////////////////////////////////////////////////////////////
-
-template<typename Node, typename NodeComparer>
-class ScoreOrderSet:
-	public cntr::RedBlackTree<ScoreComparer<Node, NodeComparer>> {
-public:
-	using RBT = cntr::RedBlackTree<ScoreComparer<Node, NodeComparer>>;
-
-	ScoreOrderSet(const ScoreComparer<Node, NodeComparer>& score_cmper):
-		RBT(score_cmper) {}
-
-	Agent<Node>* FindAgent(Agent<Node>* agent) {
-		this->RBT::Find(static_cast<ScoreOrder*>(agent));
-	}
-
-	void Insert(Agent<Node>* agent) {
-		this->RBT::Insert(static_cast<ScoreOrder*>(agent));
-	}
-
-	void Release(Agent<Node>* agent) {
-		this->RBT::Release(static_cast<ScoreOrder*>(agent));
-	}
 
 	Agent<Node>* Pop() {
 		cntr::RedBlackTreeNode* n(this->first_node());
 		this->RBT::Release(n);
-		return static_cast<Agent<Node>*>(static_cast<ScoreOrder*>(n));
+		return static_cast<Agent<Node>*>(static_cast<PosOrder*>(n));
 	}
 };
 
@@ -164,17 +133,15 @@ AStartSearch(Node* begin, Node* end, const NodeComparer& node_cmper,
 			 const NextNodeGenerator& next_node_generator,
 			 const NodeReleaser& node_releaser, const Heuristic& heuristic) {
 	using PosOrder = a_star_search_utility::PosOrder;
-	using ScoreOrder = a_star_search_utility::ScoreOrder;
 
 	using Agent = a_star_search_utility::Agent<Node>;
 
 	using PosComparer = a_star_search_utility::PosComparer<Node, NodeComparer>;
-	using ScoreComparer =
-		a_star_search_utility::ScoreComparer<Node, NodeComparer>;
+	using ScoreLessThanComparer =
+		a_star_search_utility::ScoreLessThanComparer<Node, NodeComparer>;
 
 	using PosOrderSet = a_star_search_utility::PosOrderSet<Node, NodeComparer>;
-	using ScoreOrderSet =
-		a_star_search_utility::ScoreOrderSet<Node, NodeComparer>;
+	using OpenQueue = cntr::IndexedPriorityQueue<Agent*, ScoreLessThanComparer>;
 
 	cntr::List<Node*> path;
 
@@ -189,9 +156,8 @@ AStartSearch(Node* begin, Node* end, const NodeComparer& node_cmper,
 	PosOrderSet pos_order_close_set(pos_cmper);
 	PosOrderSet pos_order_open_set(pos_cmper);
 
-	ScoreComparer score_cmper(node_cmper);
-	ScoreOrderSet score_order_close_set(score_cmper);
-	ScoreOrderSet score_order_open_set(score_cmper);
+	ScoreLessThanComparer score_lt_cmper(node_cmper);
+	OpenQueue open_queue(score_lt_cmper);
 
 	Agent* begin_agent(New<Agent>());
 	begin_agent->node = begin;
@@ -201,27 +167,20 @@ AStartSearch(Node* begin, Node* end, const NodeComparer& node_cmper,
 	begin_agent->f_score = heuristic(begin, end);
 
 	pos_order_open_set.Insert(begin_agent);
-	score_order_open_set.Insert(begin_agent);
+	begin_agent->handle = open_queue.Push(begin_agent);
 
-	while (!pos_order_open_set.empty()) {
+	while (!open_queue.empty()) {
 #if false
-		if (pos_order_open_set.size() != score_order_open_set.size()) {
-			std::cout
-				<< "pos_order_open_set.size() != score_order_open_set.size()";
-			exit(1);
-		}
-
-		if (pos_order_close_set.size() != score_order_close_set.size()) {
-			std::cout
-				<< "pos_order_close_set.size() != score_order_close_set.size()";
+		if (pos_order_open_set.size() != open_queue.size()) {
+			std::cout << "pos_order_open_set.size() != open_queue.size()";
 			exit(1);
 		}
 #endif
 
-		Agent* agent(score_order_open_set.Pop());
+		Agent* agent;
+		open_queue.Pop(agent);
 		pos_order_open_set.Release(agent);
 		pos_order_close_set.Insert(agent);
-		score_order_close_set.Insert(agent);
 
 		next_node_generator(next_nodes, agent->node);
 
@@ -234,11 +193,14 @@ AStartSearch(Node* begin, Node* end, const NodeComparer& node_cmper,
 				node_releaser(next_node);
 				path.PushBack(end);
 
-				for (; agent != nullptr; agent = agent->parent) {
-					pos_order_close_set.Release(agent);
-					score_order_close_set.Release(agent);
+				while (agent != nullptr) {
+					Agent* parent(agent->parent);
 
+					pos_order_close_set.Release(agent);
 					path.PushFront(agent->node);
+					Delete(agent);
+
+					agent = parent;
 				}
 
 				goto search_complete;
@@ -254,14 +216,20 @@ AStartSearch(Node* begin, Node* end, const NodeComparer& node_cmper,
 				static_cast<PosOrder*>(pos_order_open_set.Find(next_node))));
 
 			if (prev_agent != nullptr) {
-				if (prev_agent->g_score <= g_score) {
-					node_releaser(next_node);
-					continue;
-				}
+				node_releaser(next_node);
+
+				if (prev_agent->g_score <= g_score) { continue; }
 
-				pos_order_open_set.Release(prev_agent);
-				score_order_open_set.Release(prev_agent);
-				node_releaser(prev_agent->node);
+				// a shorter path to an open node only lowers its f_score, so
+				// the agent is updated in place and moved toward the top
+				prev_agent->f_score -= prev_agent->g_score - g_score;
+				prev_agent->parent = agent;
+				prev_agent->dist_to_parent = next_node_dist;
+				prev_agent->g_score = g_score;
+
+				open_queue.IncreaseKey(prev_agent->handle, prev_agent);
+
+				continue;
 			}
 
 			Agent* next_agent(New<Agent>());
@@ -272,7 +240,7 @@ AStartSearch(Node* begin, Node* end, const NodeComparer& node_cmper,
 			next_agent->f_score = g_score + heuristic(next_node, end);
 
 			pos_order_open_set.Insert(next_agent);
-			score_order_open_set.Insert(next_agent);
+			next_agent->handle = open_queue.Push(next_agent);
 		}
 	}
 
@@ -280,10 +248,9 @@ search_complete:;
 
 #if false
 
-	std::cout << "score_order_close_set.size() " << score_order_close_set.size()
-			  << "\n";
-	std::cout << "score_order_open_set.size() " << score_order_open_set.size()
+	std::cout << "pos_order_close_set.size() " << pos_order_close_set.size()
 			  << "\n";
+	std::cout << "open_queue.size() " << open_queue.size() << "\n";
 
 	#define MIN_X -10
 	#define MIN_Y -10
@@ -314,12 +281,16 @@ search_complete:;
 		next_nodes.PopBack();
 	}
 
-	while (!score_order_close_set.empty()) {
-		node_releaser(score_order_close_set.Pop()->node);
+	while (!pos_order_close_set.empty()) {
+		Agent* agent(pos_order_close_set.Pop());
+		node_releaser(agent->node);
+		Delete(agent);
 	}
 
-	while (!score_order_open_set.empty()) {
-		node_releaser(score_order_open_set.Pop()->node);
+	while (!pos_order_open_set.empty()) {
+		Agent* agent(pos_order_open_set.Pop());
+		node_releaser(agent->node);
+		Delete(agent);
 	}
 
 	return path;
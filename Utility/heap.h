@@ -252,15 +252,8 @@ void Make(RandomAccessIterator begin,
 
 	if (end_index < Diff(2)) { return; }
 
-	for (Diff index(1); index != end_index; ++index) {
-		Diff p_index(PHI__get_p_index(index));
-		if (!lt_cmper.lt(begin[p_index], begin[index])) { continue; }
-		Value temp(Move(begin[index]));
-		begin[index] = Move(begin[p_index]);
-		begin[PushUpwardWithValue(begin, p_index, temp, lt_cmper)] = Move(temp);
-	}
-
-	/*Diff index(PHI__get_end_p_index_which_has_r(end_index));
+	// Floyd's bottom-up build, O(n) rather than O(n log n) for sifting up
+	Diff index(PHI__get_end_p_index_which_has_r(end_index));
 
 	if (PHI__has_single_child_parent(end_index)) {
 		Diff target_index(end_index - Diff(1));
@@ -285,7 +278,7 @@ void Make(RandomAccessIterator begin,
 			begin[PushDownwardWithValue(begin, end_index, target_index, temp,
 										lt_cmper)] = Move(temp);
 		}
-	}*/
+	}
 }
 
 #///////////////////////////////////////////////////////////////////////////////
@@ -301,7 +294,6 @@ template<typename RandomAccessIterator,
 void Sort(RandomAccessIterator begin,
 		  typename iterator::trait<RandomAccessIterator>::Diff end_index,
 		  LessThanComparer&& lt_cmper = LessThanComparer()) {
-	using Value = typename iterator::trait<RandomAccessIterator>::Value;
 	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
 	for (; end_index != Diff(1); --end_index) {
 		Pop(begin, end_index, lt_cmper);
@@ -0,0 +1,203 @@
+#ifndef PHI__define_guard__Utility__incremental_sort_h
+#define PHI__define_guard__Utility__incremental_sort_h
+
+#include "sort4.h"
+
+namespace phi {
+
+/*
+IncrementalSorter sorts [begin, end) lazily, as its elements are consumed in
+order. It is the incremental quicksort of Paredes and Navarro, which keeps the
+positions of the pivots placed so far on a stack. To place the next element
+only the range between it and the nearest pivot to its right is partitioned,
+again and again, with the ranges past that pivot left alone. The first k
+elements cost O(n + k log k) expected and draining it sorts the whole range.
+
+Ranges of up to PHI__incremental_sort_insertion_sort_threshold elements are
+finished by insertion sort. Like Sort, after log2(n) highly unbalanced
+partitions the rest of the current range is handed to Sort, which bounds the
+total work at O(n log n).
+
+The range is sorted in place, elements already yielded stay at the front in
+sorted order.
+*/
+
+template<typename RandomAccessIterator,
+		 typename LessThanComparer = DefaultLessThanComparer>
+class IncrementalSorter {
+public:
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	Diff size() const;
+	bool empty() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	IncrementalSorter(RandomAccessIterator begin, RandomAccessIterator end,
+					  const LessThanComparer& lt_cmper = LessThanComparer());
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	RandomAccessIterator Next();
+
+	RandomAccessIterator SortPrefix(Diff size);
+
+private:
+	RandomAccessIterator begin_;
+	Diff size_;
+
+	Diff consumed_;
+	Diff sorted_;
+
+	int bad_allowed_;
+
+	cntr::Vector<Diff> pivots_;
+
+	LessThanComparer lt_cmper_;
+
+	void Extend_();
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__incremental_sort_insertion_sort_threshold (16)
+
+/*
+ * The number of elements not yielded yet.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+typename IncrementalSorter<RandomAccessIterator, LessThanComparer>::Diff
+IncrementalSorter<RandomAccessIterator, LessThanComparer>::size() const {
+	return this->size_ - this->consumed_;
+}
+
+template<typename RandomAccessIterator, typename LessThanComparer>
+bool IncrementalSorter<RandomAccessIterator, LessThanComparer>::empty() const {
+	return this->consumed_ == this->size_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename RandomAccessIterator, typename LessThanComparer>
+IncrementalSorter<RandomAccessIterator, LessThanComparer>::IncrementalSorter(
+	RandomAccessIterator begin, RandomAccessIterator end,
+	const LessThanComparer& lt_cmper):
+	begin_(begin),
+	size_(end - begin), consumed_(0), sorted_(0),
+	bad_allowed_(end - begin < Diff(2) ? 0 : log2int(end - begin)),
+	lt_cmper_(lt_cmper) {
+	// end works as the pivot past the last range
+	this->pivots_.Push(this->size_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Moves at least one more element to its sorted position.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+void IncrementalSorter<RandomAccessIterator, LessThanComparer>::Extend_() {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using Ref = typename iterator::trait<RandomAccessIterator>::Ref;
+
+	for (;;) {
+		Diff pivot(this->pivots_.back());
+
+		if (pivot == this->sorted_) {
+			this->pivots_.Pop();
+			++this->sorted_;
+			return;
+		}
+
+		RandomAccessIterator begin(this->begin_ + this->sorted_);
+		RandomAccessIterator end(this->begin_ + pivot);
+		Diff diff(end - begin);
+
+		if (diff <= Diff(PHI__incremental_sort_insertion_sort_threshold)) {
+			InsertionSort(begin, end, this->lt_cmper_);
+			this->sorted_ = pivot;
+			return;
+		}
+
+		if (this->bad_allowed_ == 0) {
+			Sort(begin, end, this->lt_cmper_);
+			this->sorted_ = pivot;
+			return;
+		}
+
+		// median of three to begin + 1, with sentinels at begin and end - 1
+		Ref mid(*(begin + diff / Diff(2)));
+
+		if (this->lt_cmper_.lt(mid, *begin)) { UncheckedSwap(*begin, mid); }
+
+		if (this->lt_cmper_.lt(*(end - Diff(1)), mid)) {
+			Value temp(Move(*(end - Diff(1))));
+			*(end - Diff(1)) = Move(mid);
+
+			if (this->lt_cmper_.lt(temp, *begin)) {
+				mid = Move(*begin);
+				*begin = Move(temp);
+			} else {
+				mid = Move(temp);
+			}
+		}
+
+		UncheckedSwap(*(begin + Diff(1)), mid);
+
+		RandomAccessIterator p(UnrestrictedPartition(
+			begin + Diff(2), end - Diff(1), *(begin + Diff(1)),
+			this->lt_cmper_));
+
+		Swap(*(begin + Diff(1)), *(p - Diff(1)));
+
+		Diff l_diff(p - Diff(1) - begin);
+		Diff r_diff(end - p);
+
+		if (l_diff < diff / Diff(8) || r_diff < diff / Diff(8)) {
+			--this->bad_allowed_;
+		}
+
+		this->pivots_.Push(this->sorted_ + l_diff);
+	}
+}
+
+/*
+ * Returns the next element in sorted order and moves past it.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+RandomAccessIterator
+IncrementalSorter<RandomAccessIterator, LessThanComparer>::Next() {
+	PHI__debug_if(this->consumed_ == this->size_) { PHI__throw("empty"); }
+
+	if (this->sorted_ == this->consumed_) { this->Extend_(); }
+
+	return this->begin_ + this->consumed_++;
+}
+
+/*
+ * Sorts the first size elements of the range, without yielding them, and
+ * returns the end of them. For pages of results.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+RandomAccessIterator
+IncrementalSorter<RandomAccessIterator, LessThanComparer>::SortPrefix(
+	Diff size) {
+	PHI__debug_if(size < Diff(0) || this->size_ < size) {
+		PHI__throw("size error");
+	}
+
+	while (this->sorted_ < size) { this->Extend_(); }
+
+	return this->begin_ + size;
+}
+
+#undef PHI__incremental_sort_insertion_sort_threshold
+
+}
+
+#endif
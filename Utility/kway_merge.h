@@ -0,0 +1,293 @@
+#ifndef PHI__define_guard__Utility__kway_merge_h
+#define PHI__define_guard__Utility__kway_merge_h
+
+#include "memory_op.h"
+#include "compare.h"
+#include "iterator.h"
+
+namespace phi {
+namespace loser_tree {
+
+/*
+A loser tree over k players keeps the loser of the match at every internal
+node and the overall winner at losers[0]. The nodes are laid out like a heap,
+node i has children 2i and 2i+1 and player p sits at leaf k + p, so any k
+works. After the winner changes only its path to the root is replayed, one
+match per level, which is about log2(k) comparisons against about 2 log2(k)
+for a binary heap pop.
+
+beats(x, y) returns true if player x should come out before player y.
+*/
+
+template<typename Beats>
+size_t Make_(size_t* losers, size_t k, size_t node, Beats& beats) {
+	if (k <= node) { return node - k; }
+
+	size_t l(Make_(losers, k, 2 * node, beats));
+	size_t r(Make_(losers, k, 2 * node + 1, beats));
+
+	if (beats(l, r)) {
+		losers[node] = r;
+		return l;
+	}
+
+	losers[node] = l;
+	return r;
+}
+
+/*
+ * Plays all matches of players [0, k), losers holds k entries.
+*/
+template<typename Beats> void Make(size_t* losers, size_t k, Beats&& beats) {
+	if (k != 0) { losers[0] = Make_(losers, k, 1, beats); }
+}
+
+/*
+ * Replays the matches on the path of player, whose key has changed, and
+ * updates the winner at losers[0]. player should be the previous winner.
+*/
+template<typename Beats>
+void Replay(size_t* losers, size_t k, size_t player, Beats&& beats) {
+	for (size_t node((player + k) / 2); node != 0; node /= 2) {
+		if (beats(losers[node], player)) {
+			size_t temp(losers[node]);
+			losers[node] = player;
+			player = temp;
+		}
+	}
+
+	losers[0] = player;
+}
+
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Merges the sorted ranges [runs[i].first, runs[i].second) for i in
+ * [0, runs.size()) into out and returns the end of the output. Stable, equal
+ * elements come out in the order of their runs.
+*/
+template<typename Runs, typename OutputIterator,
+		 typename LessThanComparer = DefaultLessThanComparer>
+OutputIterator KWayMerge(const Runs& runs, OutputIterator out,
+						 LessThanComparer&& lt_cmper = LessThanComparer()) {
+	using Iterator = typename remove_reference_and_const<decltype(
+		runs[0].first)>::type;
+
+	size_t k(runs.size());
+	if (k == 0) { return out; }
+
+	Iterator* begins(Malloc<Iterator>(k));
+	Iterator* ends(Malloc<Iterator>(k));
+	size_t* losers(Malloc<size_t>(k));
+
+	for (size_t i(0); i != k; ++i) {
+		new (begins + i) Iterator(runs[i].first);
+		new (ends + i) Iterator(runs[i].second);
+	}
+
+	auto beats([&](size_t x, size_t y) -> bool {
+		if (ends[y] == begins[y]) { return true; }
+		if (ends[x] == begins[x]) { return false; }
+		// ties go to the earlier run
+		return x < y ? !lt_cmper.lt(*begins[y], *begins[x])
+					 : lt_cmper.lt(*begins[x], *begins[y]);
+	});
+
+	loser_tree::Make(losers, k, beats);
+
+	for (;;) {
+		size_t winner(losers[0]);
+		if (begins[winner] == ends[winner]) { break; }
+
+		*out = *begins[winner];
+		++out;
+		++begins[winner];
+
+		loser_tree::Replay(losers, k, winner, beats);
+	}
+
+	for (size_t i(0); i != k; ++i) {
+		begins[i].~Iterator();
+		ends[i].~Iterator();
+	}
+
+	Free(losers);
+	Free(ends);
+	Free(begins);
+
+	return out;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+KWayMerger merges k streaming sources of sorted Values. A Source yields one
+element at a time through bool operator()(Value& dst), which writes the next
+element to dst or returns false once the source is exhausted. The merger is
+a Source itself, so mergers can be stacked.
+
+The sources are not owned and should outlive the merger. Only the current
+head of each source is held. Stable like KWayMerge.
+*/
+
+template<typename Value, typename Source,
+		 typename LessThanComparer = DefaultLessThanComparer>
+class KWayMerger {
+public:
+	size_t size() const;
+	bool empty() const;
+
+	const Value& top() const;
+	size_t top_source() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	KWayMerger(Source* sources, size_t source_num,
+			   const LessThanComparer& lt_cmper = LessThanComparer());
+
+	KWayMerger(const KWayMerger& merger) = delete;
+
+	~KWayMerger();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	KWayMerger& operator=(const KWayMerger& merger) = delete;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	bool Pop(Value& dst);
+
+	bool operator()(Value& dst);
+
+private:
+	struct Beats_ {
+		const KWayMerger* merger;
+		bool operator()(size_t x, size_t y) const;
+	};
+
+	Source* sources_;
+	size_t source_num_;
+	size_t size_;
+
+	Value* heads_;
+	bool* live_;
+	size_t* losers_;
+
+	LessThanComparer lt_cmper_;
+
+	void Fill_(size_t source);
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Value, typename Source, typename LessThanComparer>
+bool KWayMerger<Value, Source, LessThanComparer>::Beats_::operator()(
+	size_t x, size_t y) const {
+	const KWayMerger& m(*this->merger);
+
+	if (!m.live_[y]) { return true; }
+	if (!m.live_[x]) { return false; }
+	return x < y ? !m.lt_cmper_.lt(m.heads_[y], m.heads_[x])
+				 : m.lt_cmper_.lt(m.heads_[x], m.heads_[y]);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Value, typename Source, typename LessThanComparer>
+size_t KWayMerger<Value, Source, LessThanComparer>::size() const {
+	return this->size_;
+}
+
+template<typename Value, typename Source, typename LessThanComparer>
+bool KWayMerger<Value, Source, LessThanComparer>::empty() const {
+	return this->size_ == 0;
+}
+
+template<typename Value, typename Source, typename LessThanComparer>
+const Value& KWayMerger<Value, Source, LessThanComparer>::top() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("empty"); }
+	return this->heads_[this->losers_[0]];
+}
+
+template<typename Value, typename Source, typename LessThanComparer>
+size_t KWayMerger<Value, Source, LessThanComparer>::top_source() const {
+	PHI__debug_if(this->size_ == 0) { PHI__throw("empty"); }
+	return this->losers_[0];
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Value, typename Source, typename LessThanComparer>
+KWayMerger<Value, Source, LessThanComparer>::KWayMerger(
+	Source* sources, size_t source_num, const LessThanComparer& lt_cmper):
+	sources_(sources),
+	source_num_(source_num), size_(0), heads_(Malloc<Value>(source_num)),
+	live_(Malloc<bool>(source_num)), losers_(Malloc<size_t>(source_num)),
+	lt_cmper_(lt_cmper) {
+	for (size_t i(0); i != source_num; ++i) {
+		new (this->heads_ + i) Value();
+		this->Fill_(i);
+	}
+
+	loser_tree::Make(this->losers_, source_num, Beats_ { this });
+}
+
+template<typename Value, typename Source, typename LessThanComparer>
+KWayMerger<Value, Source, LessThanComparer>::~KWayMerger() {
+	Delete(this->source_num_, this->heads_);
+	Free(this->live_);
+	Free(this->losers_);
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Value, typename Source, typename LessThanComparer>
+void KWayMerger<Value, Source, LessThanComparer>::Fill_(size_t source) {
+	bool live(this->sources_[source](this->heads_[source]));
+	this->size_ += size_t(live);
+	this->live_[source] = live;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Moves the least head to dst and pulls the next element of its source.
+ * Returns false if every source is exhausted.
+*/
+template<typename Value, typename Source, typename LessThanComparer>
+bool KWayMerger<Value, Source, LessThanComparer>::Pop(Value& dst) {
+	if (this->size_ == 0) { return false; }
+
+	size_t winner(this->losers_[0]);
+	dst = Move(this->heads_[winner]);
+
+	--this->size_;
+	this->Fill_(winner);
+
+	loser_tree::Replay(this->losers_, this->source_num_, winner,
+					   Beats_ { this });
+
+	return true;
+}
+
+template<typename Value, typename Source, typename LessThanComparer>
+bool KWayMerger<Value, Source, LessThanComparer>::operator()(Value& dst) {
+	return this->Pop(dst);
+}
+
+}
+
+#endif
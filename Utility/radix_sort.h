@@ -0,0 +1,382 @@
+#ifndef PHI__define_guard__Utility__radix_sort_h
+#define PHI__define_guard__Utility__radix_sort_h
+
+#include <cstring>
+
+#include "sort4.h"
+
+namespace phi {
+
+/*
+RadixSort orders elements by the key key_ext returns for them without comparing
+them. Every key is first mapped to an unsigned integer of the same width whose
+order matches the order of the key, see RadixKey, then distributed one digit at
+a time.
+
+RadixSort and RadixSortWithPayload are stable. They sort least significant
+digit first through a buffer as large as the range, with 11-bit digits for 32-
+and 64-bit keys and 8-bit digits for narrower ones. The histograms of all
+digits are counted in a single pass, and a digit every key shares is skipped,
+so ids using the low 24 bits of a 64-bit key cost three passes rather than six.
+
+InPlaceRadixSort needs no buffer. It sorts most significant digit first by
+American flag sort, finishing small buckets by insertion sort, and is not
+stable.
+
+RadixKey can be specialized for other key types, it should provide the
+Unsigned type and a static Unsigned F(Key key).
+*/
+
+template<typename Key> struct RadixKey {};
+
+template<typename Unsigned_> struct UnsignedRadixKey_ {
+	using Unsigned = Unsigned_;
+	static Unsigned F(Unsigned key) { return key; }
+};
+
+template<typename Signed, typename Unsigned_> struct SignedRadixKey_ {
+	using Unsigned = Unsigned_;
+
+	static Unsigned F(Signed key) {
+		return Unsigned(key) ^ (Unsigned(1) << (8 * sizeof(Unsigned) - 1));
+	}
+};
+
+template<typename Float, typename Unsigned_> struct FloatRadixKey_ {
+	using Unsigned = Unsigned_;
+
+	static Unsigned F(Float key) {
+		static_assert(sizeof(Float) == sizeof(Unsigned), "size error");
+
+		Unsigned bits;
+		std::memcpy(&bits, &key, sizeof(Unsigned));
+
+		Unsigned sign(Unsigned(1) << (8 * sizeof(Unsigned) - 1));
+
+		// negative values are ordered backward by magnitude
+		return (bits & sign) ? Unsigned(~bits) : Unsigned(bits | sign);
+	}
+};
+
+template<>
+struct RadixKey<unsigned char>: public UnsignedRadixKey_<unsigned char> {};
+template<>
+struct RadixKey<unsigned short>: public UnsignedRadixKey_<unsigned short> {};
+template<>
+struct RadixKey<unsigned int>: public UnsignedRadixKey_<unsigned int> {};
+template<>
+struct RadixKey<unsigned long>: public UnsignedRadixKey_<unsigned long> {};
+template<>
+struct RadixKey<unsigned long long>:
+	public UnsignedRadixKey_<unsigned long long> {};
+
+template<>
+struct RadixKey<signed char>: public SignedRadixKey_<signed char, unsigned char> {
+};
+template<>
+struct RadixKey<short>: public SignedRadixKey_<short, unsigned short> {};
+template<> struct RadixKey<int>: public SignedRadixKey_<int, unsigned int> {};
+template<>
+struct RadixKey<long>: public SignedRadixKey_<long, unsigned long> {};
+template<>
+struct RadixKey<long long>:
+	public SignedRadixKey_<long long, unsigned long long> {};
+
+template<> struct RadixKey<char> {
+	using Unsigned = unsigned char;
+
+	static Unsigned F(char key) {
+		return char(-1) < char(0) ? Unsigned(Unsigned(key) ^ Unsigned(0x80))
+								  : Unsigned(key);
+	}
+};
+
+template<>
+struct RadixKey<float>: public FloatRadixKey_<float, unsigned int> {};
+template<>
+struct RadixKey<double>: public FloatRadixKey_<double, unsigned long long> {};
+
+template<typename T> struct RadixKey<T*> {
+	using Unsigned = size_t;
+	static Unsigned F(T* key) { return PHI__void_ptr_addr(key); }
+};
+
+struct DefaultRadixKeyExtractor {
+	template<typename T> const T& operator()(const T& x) const { return x; }
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__radix_sort_insertion_sort_threshold (32)
+
+template<typename KeyExtractor, typename T> struct RadixKeyOf_ {
+	using Key = typename remove_reference_and_const<decltype(
+		declval<KeyExtractor&>()(declval<T&>()))>::type;
+	using Unsigned = typename RadixKey<Key>::Unsigned;
+};
+
+/*
+ * Runs the least significant digit passes over size elements living either in
+ * the range or in the buffer. key_at(i, in_buffer) returns the unsigned key of
+ * element i, scatter(i, pos, in_buffer) moves element i to position pos of the
+ * other side. Returns true if the result is left in the buffer.
+*/
+template<typename Unsigned, typename KeyAt, typename Scatter>
+bool RadixSortPasses_(size_t size, KeyAt& key_at, Scatter& scatter) {
+	constexpr int key_bits(8 * sizeof(Unsigned));
+	constexpr int digit_bits(key_bits <= 16 ? 8 : 11);
+	constexpr int pass_num((key_bits + digit_bits - 1) / digit_bits);
+	constexpr size_t radix(size_t(1) << digit_bits);
+	constexpr Unsigned mask(radix - 1);
+
+	size_t* count(Malloc<size_t>(pass_num * radix));
+	Fill(count, count + pass_num * radix, size_t(0));
+
+	for (size_t i(0); i != size; ++i) {
+		Unsigned key(key_at(i, false));
+
+		for (int p(0); p != pass_num; ++p) {
+			++count[p * radix + ((key >> (p * digit_bits)) & mask)];
+		}
+	}
+
+	Unsigned first_key(key_at(0, false));
+	bool in_buffer(false);
+
+	for (int p(0); p != pass_num; ++p) {
+		size_t* c(count + p * radix);
+		int shift(p * digit_bits);
+
+		// every key shares this digit, the pass would keep the order
+		if (c[(first_key >> shift) & mask] == size) { continue; }
+
+		for (size_t b(0), sum(0); b != radix; ++b) {
+			size_t temp(c[b]);
+			c[b] = sum;
+			sum += temp;
+		}
+
+		for (size_t i(0); i != size; ++i) {
+			scatter(i, c[(key_at(i, in_buffer) >> shift) & mask]++, in_buffer);
+		}
+
+		in_buffer = !in_buffer;
+	}
+
+	Free(count);
+
+	return in_buffer;
+}
+
+/*
+ * Sorts the elements [begin, end) by the digits at shift and below with
+ * American flag sort. key_at(i) returns the unsigned key of element i and
+ * swapper(i, j) swaps elements i and j.
+*/
+template<typename Unsigned, typename KeyAt, typename Swapper>
+void AmericanFlagSort_(size_t begin, size_t end, int shift, KeyAt& key_at,
+					   Swapper& swapper) {
+	for (;;) {
+		if (end - begin <= PHI__radix_sort_insertion_sort_threshold) {
+			for (size_t i(begin + 1); i < end; ++i) {
+				for (size_t j(i); j != begin && key_at(j) < key_at(j - 1);
+					 --j) {
+					swapper(j, j - 1);
+				}
+			}
+
+			return;
+		}
+
+		size_t head[256];
+		size_t tail[256];
+
+		Fill(head, head + 256, size_t(0));
+
+		for (size_t i(begin); i != end; ++i) {
+			++head[(key_at(i) >> shift) & Unsigned(255)];
+		}
+
+		if (head[(key_at(begin) >> shift) & Unsigned(255)] == end - begin) {
+			if (shift == 0) { return; }
+			shift -= 8;
+			continue;
+		}
+
+		for (size_t b(0), sum(begin); b != 256; ++b) {
+			size_t temp(head[b]);
+			head[b] = sum;
+			sum += temp;
+			tail[b] = sum;
+		}
+
+		for (size_t b(0); b != 256; ++b) {
+			while (head[b] != tail[b]) {
+				size_t d((key_at(head[b]) >> shift) & Unsigned(255));
+
+				if (d == b) {
+					++head[b];
+				} else {
+					swapper(head[b], head[d]++);
+				}
+			}
+		}
+
+		if (shift == 0) { return; }
+
+		for (size_t b(0), prev(begin); b != 256; prev = tail[b++]) {
+			if (1 < tail[b] - prev) {
+				AmericanFlagSort_<Unsigned>(prev, tail[b], shift - 8, key_at,
+											swapper);
+			}
+		}
+
+		return;
+	}
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Sorts [begin, end) in place by the keys key_ext returns with American flag
+ * sort. Not stable.
+*/
+template<typename RandomAccessIterator,
+		 typename KeyExtractor = DefaultRadixKeyExtractor>
+void InPlaceRadixSort(RandomAccessIterator begin, RandomAccessIterator end,
+					  KeyExtractor&& key_ext = KeyExtractor()) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using KeyOf = RadixKeyOf_<KeyExtractor, Value>;
+	using Unsigned = typename KeyOf::Unsigned;
+
+	if (!(begin < end)) { return; }
+
+	auto key_at([&](size_t i) -> Unsigned {
+		return RadixKey<typename KeyOf::Key>::F(key_ext(begin[i]));
+	});
+
+	auto swapper([&](size_t i, size_t j) { Swap(begin[i], begin[j]); });
+
+	AmericanFlagSort_<Unsigned>(0, end - begin, 8 * sizeof(Unsigned) - 8,
+								key_at, swapper);
+}
+
+/*
+ * Sorts [begin, end) stably by the keys key_ext returns.
+*/
+template<typename RandomAccessIterator,
+		 typename KeyExtractor = DefaultRadixKeyExtractor>
+void RadixSort(RandomAccessIterator begin, RandomAccessIterator end,
+			   KeyExtractor&& key_ext = KeyExtractor()) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using KeyOf = RadixKeyOf_<KeyExtractor, Value>;
+	using Unsigned = typename KeyOf::Unsigned;
+
+	if (!(begin < end)) { return; }
+
+	size_t size(end - begin);
+
+	// InPlaceRadixSort only runs insertion sort on so few, which is stable
+	if (size <= PHI__radix_sort_insertion_sort_threshold) {
+		InPlaceRadixSort(begin, end, key_ext);
+		return;
+	}
+
+	Value* buffer(Malloc<Value>(size));
+
+	auto key_at([&](size_t i, bool in_buffer) -> Unsigned {
+		if (in_buffer) {
+			return RadixKey<typename KeyOf::Key>::F(key_ext(buffer[i]));
+		}
+
+		return RadixKey<typename KeyOf::Key>::F(key_ext(begin[i]));
+	});
+
+	auto scatter([&](size_t i, size_t pos, bool in_buffer) {
+		if (in_buffer) {
+			begin[pos] = Move(buffer[i]);
+			buffer[i].~Value();
+		} else {
+			new (buffer + pos) Value(Move(begin[i]));
+		}
+	});
+
+	if (RadixSortPasses_<Unsigned>(size, key_at, scatter)) {
+		for (size_t i(0); i != size; ++i) { scatter(i, i, true); }
+	}
+
+	Free(buffer);
+}
+
+/*
+ * Sorts the keys [key_begin, key_end) by the keys key_ext returns and applies
+ * the same permutation to the payloads starting at payload_begin. Stable.
+*/
+template<typename KeyIterator, typename PayloadIterator,
+		 typename KeyExtractor = DefaultRadixKeyExtractor>
+void RadixSortWithPayload(KeyIterator key_begin, KeyIterator key_end,
+						  PayloadIterator payload_begin,
+						  KeyExtractor&& key_ext = KeyExtractor()) {
+	using Key = typename iterator::trait<KeyIterator>::Value;
+	using Payload = typename iterator::trait<PayloadIterator>::Value;
+	using KeyOf = RadixKeyOf_<KeyExtractor, Key>;
+	using Unsigned = typename KeyOf::Unsigned;
+
+	if (!(key_begin < key_end)) { return; }
+
+	size_t size(key_end - key_begin);
+
+	if (size <= PHI__radix_sort_insertion_sort_threshold) {
+		auto key_at([&](size_t i) -> Unsigned {
+			return RadixKey<typename KeyOf::Key>::F(key_ext(key_begin[i]));
+		});
+
+		auto swapper([&](size_t i, size_t j) {
+			Swap(key_begin[i], key_begin[j]);
+			Swap(payload_begin[i], payload_begin[j]);
+		});
+
+		AmericanFlagSort_<Unsigned>(0, size, 8 * sizeof(Unsigned) - 8, key_at,
+									swapper);
+
+		return;
+	}
+
+	Key* key_buffer(Malloc<Key>(size));
+	Payload* payload_buffer(Malloc<Payload>(size));
+
+	auto key_at([&](size_t i, bool in_buffer) -> Unsigned {
+		if (in_buffer) {
+			return RadixKey<typename KeyOf::Key>::F(key_ext(key_buffer[i]));
+		}
+
+		return RadixKey<typename KeyOf::Key>::F(key_ext(key_begin[i]));
+	});
+
+	auto scatter([&](size_t i, size_t pos, bool in_buffer) {
+		if (in_buffer) {
+			key_begin[pos] = Move(key_buffer[i]);
+			payload_begin[pos] = Move(payload_buffer[i]);
+			key_buffer[i].~Key();
+			payload_buffer[i].~Payload();
+		} else {
+			new (key_buffer + pos) Key(Move(key_begin[i]));
+			new (payload_buffer + pos) Payload(Move(payload_begin[i]));
+		}
+	});
+
+	if (RadixSortPasses_<Unsigned>(size, key_at, scatter)) {
+		for (size_t i(0); i != size; ++i) { scatter(i, i, true); }
+	}
+
+	Free(key_buffer);
+	Free(payload_buffer);
+}
+
+#undef PHI__radix_sort_insertion_sort_threshold
+
+}
+
+#endif
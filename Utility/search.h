@@ -131,9 +131,13 @@ LinearSearch(size_t size, ForwardIterator begin, const Index& index,
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 
+/*
+ * Returns the iterator of the element equal to index in sorted [begin, end),
+ * or end if there is no such element.
+*/
 template<typename RandomAccessIterator, typename Index,
 		 typename FullComparer = DefaultFullComparer>
-typename iterator::trait<RandomAccessIterator>::Diff
+RandomAccessIterator
 BinarySearch(RandomAccessIterator begin, RandomAccessIterator end,
 			 const Index& index, FullComparer full_cmper = FullComparer()) {
 	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
@@ -153,6 +157,30 @@ BinarySearch(RandomAccessIterator begin, RandomAccessIterator end,
 	return not_find;
 }
 
+/*
+ * Returns the first iterator in sorted [begin, end) whose element is not less
+ * than index, or end if there is no such element.
+*/
+template<typename RandomAccessIterator, typename Index,
+		 typename FullComparer = DefaultFullComparer>
+RandomAccessIterator LowerBound(RandomAccessIterator begin,
+								RandomAccessIterator end, const Index& index,
+								FullComparer full_cmper = FullComparer()) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	while (begin < end) {
+		RandomAccessIterator mid(begin + (end - begin) / Diff(2));
+
+		if (full_cmper(index, *mid) == 1) {
+			begin = mid + Diff(1);
+		} else {
+			end = mid;
+		}
+	}
+
+	return begin;
+}
+
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
@@ -1,6 +1,13 @@
 #ifndef PHI__define_guard__Utility__sort_h
 #define PHI__define_guard__Utility__sort_h
 
+#include <limits>
+#include <thread>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
 #include "memory_op.h"
 #include "compare.h"
 #include "search.h"
@@ -79,7 +86,7 @@ void ConvolutionSwapIfDisorder_(
 template<typename RandomAccessIterator,
 		 typename LessThanComparer = DefaultLessThanComparer>
 void ConvolutionSwapIfDisorder_(
-	iterator::Type::RandomAccess iterator_type, RandomAccessIterator begin,
+	iterator::Type::RandomAccess, RandomAccessIterator begin,
 	RandomAccessIterator end,
 	LessThanComparer&& lt_cmper = LessThanComparer()) {
 	if (!(begin < end)) { return; }
@@ -320,6 +327,410 @@ void SelectionSort(ForwardIterator begin, ForwardIterator end,
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 
+/*
+Sorting networks for the small ranges left by Sort_ and IntroSort_. The range
+is copied into a buffer of 8, 16 or 32 elements padded with its maximum and
+sorted by a bitonic network, so no comparison decides a branch. With AVX2
+enabled the buffer is kept in vector registers and every stage is a min/max
+between vectors or between permuted lanes, otherwise the stages are scalar
+selects the compiler may vectorize.
+
+Only used for arithmetic elements compared by DefaultLessThanComparer.
+*/
+
+template<typename Value> struct sorting_network_type_ {
+	static constexpr bool value = false;
+};
+
+template<> struct sorting_network_type_<int> {
+	static constexpr bool value = true;
+};
+template<> struct sorting_network_type_<unsigned int> {
+	static constexpr bool value = true;
+};
+template<> struct sorting_network_type_<long> {
+	static constexpr bool value = true;
+};
+template<> struct sorting_network_type_<unsigned long> {
+	static constexpr bool value = true;
+};
+template<> struct sorting_network_type_<long long> {
+	static constexpr bool value = true;
+};
+template<> struct sorting_network_type_<unsigned long long> {
+	static constexpr bool value = true;
+};
+template<> struct sorting_network_type_<float> {
+	static constexpr bool value = true;
+};
+template<> struct sorting_network_type_<double> {
+	static constexpr bool value = true;
+};
+
+template<typename Value, typename LessThanComparer>
+struct use_sorting_network_ {
+	static constexpr bool value =
+		sorting_network_type_<Value>::value &&
+		is_same<typename remove_reference_and_const<LessThanComparer>::type,
+				DefaultLessThanComparer>::value;
+};
+
+/*
+ * Compare-exchanges x[i] and y[i] for every i in [0, size), or x[i] and
+ * y[size - 1 - i] if reverse.
+*/
+template<size_t size, bool reverse, typename Value>
+void SortingNetworkMinMax_(Value* x, Value* y) {
+	for (size_t i(0); i != size; ++i) {
+		Value& y_i(y[reverse ? size - 1 - i : i]);
+		bool swap(y_i < x[i]);
+		Value lo(swap ? y_i : x[i]);
+		Value hi(swap ? x[i] : y_i);
+		x[i] = lo;
+		y_i = hi;
+	}
+}
+
+/*
+ * Bitonic sort of x[0, size), size is a power of two. Each merge of two
+ * blocks of k / 2 starts by comparing mirrored elements, so every stage sorts
+ * upward.
+*/
+template<size_t size, size_t k = 2, size_t j = k / 2, typename Value>
+void SortingNetwork_(Value* x) {
+	if constexpr (k <= size) {
+		if constexpr (j == 0) {
+			SortingNetwork_<size, k * 2>(x);
+		} else {
+			for (size_t i(0); i != size; i += 2 * j) {
+				SortingNetworkMinMax_<j, j == k / 2>(x + i, x + i + j);
+			}
+
+			SortingNetwork_<size, k, j / 2>(x);
+		}
+	}
+}
+
+#if defined(__AVX2__)
+
+template<typename Value, size_t size = sizeof(Value)>
+struct SortingNetworkVector_ {
+	static constexpr size_t width = 0;
+};
+
+template<typename Int> struct SortingNetworkIntVector_ {
+	using Vec = __m256i;
+
+	static constexpr size_t width = 32 / sizeof(Int);
+
+	// whether equal elements may differ
+	static constexpr bool distinct_equal = false;
+
+	static Vec Load(const Int* src) {
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+	}
+
+	static void Store(Int* dst, Vec v) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+	}
+
+	static Vec Permute(Vec v, __m256i index) {
+		return _mm256_permutevar8x32_epi32(v, index);
+	}
+
+	static Vec Select(Vec x, Vec y, __m256i mask) {
+		return _mm256_blendv_epi8(x, y, mask);
+	}
+
+	static Vec Broadcast(Int x) {
+		if constexpr (sizeof(Int) == 4) {
+			return _mm256_set1_epi32(x);
+		} else {
+			return _mm256_set1_epi64x(x);
+		}
+	}
+
+	// bit i is set if x[i] < y[i]
+	static int LessMask(Vec x, Vec y) {
+		if constexpr (sizeof(Int) == 4) {
+			Vec bias(_mm256_set1_epi32(Int(-1) < Int(0) ? 0 : (1 << 31)));
+			return _mm256_movemask_ps(_mm256_castsi256_ps(
+				_mm256_cmpgt_epi32(_mm256_xor_si256(y, bias),
+								   _mm256_xor_si256(x, bias))));
+		} else {
+			Vec bias(_mm256_set1_epi64x(Int(-1) < Int(0) ? 0 : (1LL << 63)));
+			return _mm256_movemask_pd(_mm256_castsi256_pd(
+				_mm256_cmpgt_epi64(_mm256_xor_si256(y, bias),
+								   _mm256_xor_si256(x, bias))));
+		}
+	}
+
+	static void MinMax(Vec x, Vec y, Vec& lo, Vec& hi) {
+		if constexpr (sizeof(Int) == 4) {
+			if constexpr (Int(-1) < Int(0)) {
+				lo = _mm256_min_epi32(x, y);
+				hi = _mm256_max_epi32(x, y);
+			} else {
+				lo = _mm256_min_epu32(x, y);
+				hi = _mm256_max_epu32(x, y);
+			}
+		} else {
+			// there is no 64-bit min, select by a signed comparison instead
+			Vec bias(_mm256_set1_epi64x(Int(-1) < Int(0) ? 0 : (1LL << 63)));
+			Vec m(_mm256_cmpgt_epi64(_mm256_xor_si256(x, bias),
+									 _mm256_xor_si256(y, bias)));
+			lo = _mm256_blendv_epi8(x, y, m);
+			hi = _mm256_blendv_epi8(y, x, m);
+		}
+	}
+};
+
+template<typename Int>
+struct SortingNetworkVector_<Int, 4>: public SortingNetworkIntVector_<Int> {};
+
+template<typename Int>
+struct SortingNetworkVector_<Int, 8>: public SortingNetworkIntVector_<Int> {};
+
+template<> struct SortingNetworkVector_<float, 4> {
+	using Vec = __m256;
+
+	static constexpr size_t width = 8;
+
+	// -0.0 and +0.0
+	static constexpr bool distinct_equal = true;
+
+	static Vec Load(const float* src) { return _mm256_loadu_ps(src); }
+	static void Store(float* dst, Vec v) { _mm256_storeu_ps(dst, v); }
+
+	static Vec Permute(Vec v, __m256i index) {
+		return _mm256_permutevar8x32_ps(v, index);
+	}
+
+	static Vec Select(Vec x, Vec y, __m256i mask) {
+		return _mm256_blendv_ps(x, y, _mm256_castsi256_ps(mask));
+	}
+
+	static Vec Broadcast(float x) { return _mm256_set1_ps(x); }
+
+	static int LessMask(Vec x, Vec y) {
+		return _mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_LT_OQ));
+	}
+
+	static void MinMax(Vec x, Vec y, Vec& lo, Vec& hi) {
+		// min and max return y for both -0.0 and +0.0, which would duplicate
+		// one zero and lose the other, so lo is x and hi is y on ties instead
+		Vec m(_mm256_cmp_ps(y, x, _CMP_LT_OQ));
+		lo = _mm256_blendv_ps(x, y, m);
+		hi = _mm256_blendv_ps(y, x, m);
+	}
+};
+
+template<> struct SortingNetworkVector_<double, 8> {
+	using Vec = __m256d;
+
+	static constexpr size_t width = 4;
+
+	// -0.0 and +0.0
+	static constexpr bool distinct_equal = true;
+
+	static Vec Load(const double* src) { return _mm256_loadu_pd(src); }
+	static void Store(double* dst, Vec v) { _mm256_storeu_pd(dst, v); }
+
+	static Vec Permute(Vec v, __m256i index) {
+		return _mm256_castsi256_pd(
+			_mm256_permutevar8x32_epi32(_mm256_castpd_si256(v), index));
+	}
+
+	static Vec Select(Vec x, Vec y, __m256i mask) {
+		return _mm256_blendv_pd(x, y, _mm256_castsi256_pd(mask));
+	}
+
+	static Vec Broadcast(double x) { return _mm256_set1_pd(x); }
+
+	static int LessMask(Vec x, Vec y) {
+		return _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_LT_OQ));
+	}
+
+	static void MinMax(Vec x, Vec y, Vec& lo, Vec& hi) {
+		// lo is x and hi is y on ties, see SortingNetworkVector_<float, 4>
+		Vec m(_mm256_cmp_pd(y, x, _CMP_LT_OQ));
+		lo = _mm256_blendv_pd(x, y, m);
+		hi = _mm256_blendv_pd(y, x, m);
+	}
+};
+
+template<typename V, size_t partner> __m256i SortingNetworkIndex_() {
+	if constexpr (V::width == 8) {
+		return _mm256_setr_epi32(0 ^ partner, 1 ^ partner, 2 ^ partner,
+								 3 ^ partner, 4 ^ partner, 5 ^ partner,
+								 6 ^ partner, 7 ^ partner);
+	} else {
+		return _mm256_setr_epi32(
+			2 * (0 ^ partner), 2 * (0 ^ partner) + 1, 2 * (1 ^ partner),
+			2 * (1 ^ partner) + 1, 2 * (2 ^ partner), 2 * (2 ^ partner) + 1,
+			2 * (3 ^ partner), 2 * (3 ^ partner) + 1);
+	}
+}
+
+/*
+ * Compare-exchanges lane i of v with lane i ^ partner, lane i keeps the
+ * larger one if i & high is not 0.
+*/
+template<typename V, size_t partner, size_t high>
+typename V::Vec SortingNetworkExchange_(typename V::Vec v) {
+	__m256i mask;
+
+	if constexpr (V::width == 8) {
+		mask = _mm256_setr_epi32(-int(bool(0 & high)), -int(bool(1 & high)),
+								 -int(bool(2 & high)), -int(bool(3 & high)),
+								 -int(bool(4 & high)), -int(bool(5 & high)),
+								 -int(bool(6 & high)), -int(bool(7 & high)));
+	} else {
+		mask = _mm256_setr_epi64x(
+			-(long long)(bool(0 & high)), -(long long)(bool(1 & high)),
+			-(long long)(bool(2 & high)), -(long long)(bool(3 & high)));
+	}
+
+	typename V::Vec p(V::Permute(v, SortingNetworkIndex_<V, partner>()));
+	typename V::Vec lo, hi;
+
+	if constexpr (V::distinct_equal) {
+		// MinMax gives lo x and hi y on ties, swap them in the high lanes so
+		// every lane keeps its own element on ties
+		V::MinMax(V::Select(v, p, mask), V::Select(p, v, mask), lo, hi);
+	} else {
+		V::MinMax(v, p, lo, hi);
+	}
+
+	return V::Select(lo, hi, mask);
+}
+
+/*
+ * SortingNetwork_ over size / V::width vectors. Stages comparing elements at
+ * least a vector apart work on pairs of vectors, the others exchange lanes
+ * within each vector.
+*/
+template<typename V, size_t size, size_t k = 2, size_t j = k / 2>
+void VectorSortingNetwork_(typename V::Vec* v) {
+	using Vec = typename V::Vec;
+
+	constexpr size_t w(V::width);
+	constexpr bool mirror(j == k / 2);
+
+	if constexpr (k <= size) {
+		if constexpr (j == 0) {
+			VectorSortingNetwork_<V, size, k * 2>(v);
+		} else if constexpr (j < w) {
+			for (size_t i(0); i != size / w; ++i) {
+				v[i] = SortingNetworkExchange_<V, mirror ? k - 1 : j, j>(v[i]);
+			}
+
+			VectorSortingNetwork_<V, size, k, j / 2>(v);
+		} else {
+			for (size_t i(0); i != size / w; i += 2 * j / w) {
+				for (size_t t(0); t != j / w; ++t) {
+					Vec& x(v[i + t]);
+					Vec& y(v[mirror ? i + 2 * j / w - 1 - t : i + j / w + t]);
+
+					Vec lo, hi;
+
+					if constexpr (mirror) {
+						__m256i reverse(SortingNetworkIndex_<V, w - 1>());
+						V::MinMax(x, V::Permute(y, reverse), lo, hi);
+						hi = V::Permute(hi, reverse);
+					} else {
+						V::MinMax(x, y, lo, hi);
+					}
+
+					x = lo;
+					y = hi;
+				}
+			}
+
+			VectorSortingNetwork_<V, size, k, j / 2>(v);
+		}
+	}
+}
+
+#endif
+
+template<size_t size, typename Value> void SortingNetworkBuffer_(Value* x) {
+#if defined(__AVX2__)
+	using V = SortingNetworkVector_<Value>;
+
+	if constexpr (V::width != 0) {
+		typename V::Vec v[size / V::width];
+
+		for (size_t i(0); i != size / V::width; ++i) {
+			v[i] = V::Load(x + i * V::width);
+		}
+
+		VectorSortingNetwork_<V, size>(v);
+
+		for (size_t i(0); i != size / V::width; ++i) {
+			V::Store(x + i * V::width, v[i]);
+		}
+
+		return;
+	}
+#endif
+
+	SortingNetwork_<size>(x);
+}
+
+/*
+ * Sorts [begin, end) of at most 32 elements with a sorting network. Returns
+ * false, leaving the range untouched, if it holds a NaN.
+*/
+template<typename RandomAccessIterator>
+bool SortingNetworkSort_(RandomAccessIterator begin,
+						 RandomAccessIterator end) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+
+	size_t size(end - begin);
+	if (size < 2) { return true; }
+
+	PHI__debug_if(32 < size) { PHI__throw("size error"); }
+
+	Value buffer[32];
+	Value max(*begin);
+	bool nan(false);
+
+	for (size_t i(0); i != size; ++i) {
+		buffer[i] = begin[i];
+		nan |= buffer[i] != buffer[i];
+		max = max < buffer[i] ? buffer[i] : max;
+	}
+
+	if (nan) { return false; }
+
+	// -0.0 and +0.0 are equal, so copies of a zero max could come out in
+	// place of the other zeros, pad floating points with +inf instead
+	if constexpr (is_same<Value, float>::value ||
+				  is_same<Value, double>::value) {
+		max = std::numeric_limits<Value>::infinity();
+	}
+
+	if (size <= 8) {
+		for (size_t i(size); i != 8; ++i) { buffer[i] = max; }
+		SortingNetworkBuffer_<8>(buffer);
+	} else if (size <= 16) {
+		for (size_t i(size); i != 16; ++i) { buffer[i] = max; }
+		SortingNetworkBuffer_<16>(buffer);
+	} else {
+		for (size_t i(size); i != 32; ++i) { buffer[i] = max; }
+		SortingNetworkBuffer_<32>(buffer);
+	}
+
+	for (size_t i(0); i != size; ++i) { begin[i] = buffer[i]; }
+
+	return true;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
 template<typename RandomAccessIterator,
 		 typename LessThanComparer = DefaultLessThanComparer>
 void QuickSort(RandomAccessIterator begin, RandomAccessIterator end,
@@ -395,7 +806,13 @@ void IntroSort_(
 
 		Diff diff(end - begin);
 
-		if (diff <= Diff(8)) { break; }
+		if (diff <= Diff(8)) {
+			if constexpr (use_sorting_network_<Value, LessThanComparer>::value) {
+				if (SortingNetworkSort_(begin, end)) { return; }
+			}
+
+			break;
+		}
 
 		Ref mid(*(begin + diff / Diff(2)));
 
@@ -438,9 +855,13 @@ void IntroSort(RandomAccessIterator begin, RandomAccessIterator end,
 #///////////////////////////////////////////////////////////////////////////////
 #///////////////////////////////////////////////////////////////////////////////
 
-int log2int_(unsigned int num) {
+/*
+ * Returns the number of bits of num, 0 for 0.
+*/
+inline int log2int_(unsigned long long int num) {
 #if (defined(__GNUC__) || defined(__GNUG__)) && true
-	return 8 * sizeof(unsigned int) - __builtin_clz(num);
+	if (num == 0) { return 0; }
+	return 8 * sizeof(unsigned long long int) - __builtin_clzll(num);
 #else
 	int r(0);
 
@@ -480,7 +901,7 @@ int log2int_(unsigned int num) {
 		r += 1 * a;
 	}
 
-	return r;
+	return r + int(num);
 #endif
 }
 
@@ -490,141 +911,365 @@ template<typename Num> int log2int(Num num) {
 	return log2int_((unsigned long long int)(num));
 }
 
-template<typename Diff> Diff SortGetN_(Diff diff) {
-	Diff n(diff / Diff(1024 * 2));
-	return (n < Diff(3)) ? Diff(3) : (n | Diff(1));
+#define PHI__ninther_threshold (128)
+#define PHI__partial_insertion_sort_limit (8)
+#define PHI__partition_block_size (64)
+
+template<typename RandomAccessIterator, typename LessThanComparer>
+void SortThree_(RandomAccessIterator x, RandomAccessIterator y,
+				RandomAccessIterator z, LessThanComparer&& lt_cmper) {
+	if (lt_cmper.lt(*y, *x)) { UncheckedSwap(*x, *y); }
+
+	if (lt_cmper.lt(*z, *y)) {
+		UncheckedSwap(*y, *z);
+		if (lt_cmper.lt(*y, *x)) { UncheckedSwap(*x, *y); }
+	}
 }
 
-template<typename Diff> Diff SortGetM_(Diff diff) {
-	return SortGetN_(diff) / Diff(2);
+/*
+ * Moves the pivot of [begin, end) to begin, the median of three elements for
+ * short ranges and the median of three medians of three otherwise. Also
+ * leaves an element not less than the pivot at end - 1.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+void SortChoosePivot_(RandomAccessIterator begin, RandomAccessIterator end,
+					  LessThanComparer&& lt_cmper) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	Diff diff(end - begin);
+	Diff half(diff / Diff(2));
+
+	if (diff <= Diff(PHI__ninther_threshold)) {
+		SortThree_(begin + half, begin, end - Diff(1), lt_cmper);
+		return;
+	}
+
+	SortThree_(begin, begin + half, end - Diff(1), lt_cmper);
+	SortThree_(begin + Diff(1), begin + (half - Diff(1)), end - Diff(2),
+			   lt_cmper);
+	SortThree_(begin + Diff(2), begin + (half + Diff(1)), end - Diff(3),
+			   lt_cmper);
+	SortThree_(begin + (half - Diff(1)), begin + half,
+			   begin + (half + Diff(1)), lt_cmper);
+	UncheckedSwap(*begin, *(begin + half));
 }
 
-template<bool begin_is_heap, typename RandomAccessIterator,
-		 typename LessThanComparer>
-void Sort_(typename iterator::trait<RandomAccessIterator>::Diff depth_limit,
-		   RandomAccessIterator begin, RandomAccessIterator end,
-		   LessThanComparer&& lt_cmper) {
+/*
+ * Partitions [begin, end) around the pivot at begin, elements less than the
+ * pivot to its left and the others to its right, and returns the final
+ * position of the pivot. Requires an element not less than the pivot in
+ * (begin, end), SortChoosePivot_ leaves one at end - 1.
+ *
+ * After the first misplaced pair, the rest is partitioned BlockQuicksort
+ * style: the comparisons of a block of elements from each side are recorded
+ * as offsets of the misplaced ones without branching on their results, then
+ * the recorded elements are exchanged in a cycle. already_partitioned is set
+ * if no element needed to move.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+RandomAccessIterator
+PartitionRight_(RandomAccessIterator begin, RandomAccessIterator end,
+				bool& already_partitioned, LessThanComparer&& lt_cmper) {
 	using Value = typename iterator::trait<RandomAccessIterator>::Value;
-	using Ref = typename iterator::trait<RandomAccessIterator>::Ref;
 	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
 
-	for (;;) {
-		Diff diff(end - begin);
+	Value pivot(Move(*begin));
 
-		if (diff <= Diff(PHI__insertion_sort_threshold)) {
-			UnrestrictedInsertionSort(begin, end, lt_cmper);
-			return;
-		}
+	RandomAccessIterator first(begin);
+	RandomAccessIterator last(end);
 
-		if (depth_limit == Diff(0)) {
-			HeapSort(begin, end, lt_cmper);
-			return;
-		}
+	while (lt_cmper.lt(*++first, pivot)) {}
 
-		Diff m(SortGetM_(diff));
+	if (first - Diff(1) == begin) {
+		while (first < last && !lt_cmper.lt(*--last, pivot)) {}
+	} else {
+		while (!lt_cmper.lt(*--last, pivot)) {}
+	}
 
-		if (m == Diff(1)) {
-			Sort_n_is_three_(depth_limit, begin, end, lt_cmper);
-			return;
-		}
+	already_partitioned = !(first < last);
 
-		depth_limit /= Diff(2);
+	if (!already_partitioned) {
+		UncheckedSwap(*first, *last);
+		++first;
 
-		if constexpr (!begin_is_heap) { heap::Make(begin, m, lt_cmper); }
+		unsigned char offsets_l[PHI__partition_block_size];
+		unsigned char offsets_r[PHI__partition_block_size];
 
-		Ref mid(*(begin + diff / Diff(2)));
+		RandomAccessIterator base_l(first);
+		RandomAccessIterator base_r(last);
 
-		if (lt_cmper.lt(mid, *begin)) {
-			Value temp(Move(*begin));
-			begin[heap::PushDownwardWithValue(begin, m, Diff(0), mid,
-											  lt_cmper)] = Move(mid);
-			mid = Move(temp);
-		}
+		size_t num_l(0);
+		size_t num_r(0);
+		size_t start_l(0);
+		size_t start_r(0);
 
-		for (RandomAccessIterator i(end - m); i != end; ++i) {
-			if (!lt_cmper.lt(*i, mid)) { continue; }
+		while (first < last) {
+			size_t unknown(last - first);
+			size_t split_l(num_l != 0   ? 0
+						   : num_r == 0 ? unknown / 2
+										: unknown);
+			size_t split_r(num_r != 0 ? 0 : unknown - split_l);
 
-			if (lt_cmper.lt(*i, *begin)) {
-				Value temp(Move(*begin));
-				begin[heap::PushDownwardWithValue(begin, m, Diff(0), *i,
-												  lt_cmper)] = Move(*i);
-				*i = Move(mid);
-				mid = Move(temp);
-			} else {
-				Swap(*i, mid);
+			if (PHI__partition_block_size < split_l) {
+				split_l = PHI__partition_block_size;
 			}
-		}
 
-		UncheckedSwap(*(begin + m), mid);
+			if (PHI__partition_block_size < split_r) {
+				split_r = PHI__partition_block_size;
+			}
 
-		RandomAccessIterator p(UnrestrictedPartition(
-			begin + m + Diff(1), end - m, *(begin + m), lt_cmper));
+			for (size_t i(0); i != split_l; ++i, ++first) {
+				offsets_l[num_l] = (unsigned char)(i);
+				num_l += !lt_cmper.lt(*first, pivot);
+			}
 
-		Swap(*(begin + m), *(p - Diff(1)));
+			for (size_t i(0); i != split_r; ++i) {
+				offsets_r[num_r] = (unsigned char)(i + 1);
+				num_r += lt_cmper.lt(*--last, pivot);
+			}
 
-		if constexpr (begin_is_heap) {
-			Sort_<false>(depth_limit, p, end, lt_cmper);
-			end = p - Diff(1);
-		} else {
-			Sort_<true>(depth_limit, begin, p - Diff(1), lt_cmper);
-			begin = p;
+			size_t num(num_l < num_r ? num_l : num_r);
+
+			if (num != 0) {
+				unsigned char* o_l(offsets_l + start_l);
+				unsigned char* o_r(offsets_r + start_r);
+
+				if (num_l == num_r) {
+					// plain swaps keep a descending block descending on the
+					// other side, where the next partial insertion sort can
+					// finish it
+					for (size_t i(0); i != num; ++i) {
+						UncheckedSwap(*(base_l + Diff(o_l[i])),
+									  *(base_r - Diff(o_r[i])));
+					}
+				} else {
+					RandomAccessIterator l(base_l + Diff(o_l[0]));
+					RandomAccessIterator r(base_r - Diff(o_r[0]));
+
+					Value temp(Move(*l));
+					*l = Move(*r);
+
+					for (size_t i(1); i != num; ++i) {
+						l = base_l + Diff(o_l[i]);
+						*r = Move(*l);
+						r = base_r - Diff(o_r[i]);
+						*l = Move(*r);
+					}
+
+					*r = Move(temp);
+				}
+			}
+
+			num_l -= num;
+			num_r -= num;
+			start_l += num;
+			start_r += num;
+
+			if (num_l == 0) {
+				start_l = 0;
+				base_l = first;
+			}
+
+			if (num_r == 0) {
+				start_r = 0;
+				base_r = last;
+			}
+		}
+
+		// one side is exhausted, move the rest of the other one across
+		if (num_l != 0) {
+			while (num_l != 0) {
+				--num_l;
+				UncheckedSwap(*(base_l + Diff(offsets_l[start_l + num_l])),
+							  *--last);
+			}
+
+			first = last;
+		}
+
+		if (num_r != 0) {
+			while (num_r != 0) {
+				--num_r;
+				UncheckedSwap(*(base_r - Diff(offsets_r[start_r + num_r])),
+							  *first);
+				++first;
+			}
 		}
 	}
+
+	RandomAccessIterator p(first - Diff(1));
+	*begin = Move(*p);
+	*p = Move(pivot);
+
+	return p;
 }
 
+/*
+ * Partitions [begin, end) around the pivot at begin, elements not greater
+ * than the pivot to its left and the others to its right, and returns the
+ * final position of the pivot. Used when the pivot equals the element right
+ * before begin, so the left side holds only elements equal to the pivot.
+*/
 template<typename RandomAccessIterator, typename LessThanComparer>
-void Sort_n_is_three_(
-	typename iterator::trait<RandomAccessIterator>::Diff depth_limit,
-	RandomAccessIterator begin, RandomAccessIterator end,
-	LessThanComparer&& lt_cmper) {
+RandomAccessIterator PartitionLeft_(RandomAccessIterator begin,
+									RandomAccessIterator end,
+									LessThanComparer&& lt_cmper) {
 	using Value = typename iterator::trait<RandomAccessIterator>::Value;
-	using Ref = typename iterator::trait<RandomAccessIterator>::Ref;
 	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
 
-	for (;;) {
-		Diff diff(end - begin);
+	Value pivot(Move(*begin));
 
-		if (diff <= Diff(PHI__insertion_sort_threshold)) {
-			UnrestrictedInsertionSort(begin, end, lt_cmper);
-			return;
-		}
+	RandomAccessIterator first(begin);
+	RandomAccessIterator last(end);
 
-		if (depth_limit == Diff(0)) {
-			HeapSort(begin, end, lt_cmper);
-			return;
-		}
+	while (lt_cmper.lt(pivot, *--last)) {}
 
-		depth_limit /= Diff(2);
+	if (last + Diff(1) == end) {
+		while (first < last && !lt_cmper.lt(pivot, *++first)) {}
+	} else {
+		while (!lt_cmper.lt(pivot, *++first)) {}
+	}
 
-		Ref mid(*(begin + diff / Diff(2)));
+	while (first < last) {
+		UncheckedSwap(*first, *last);
+		while (lt_cmper.lt(pivot, *--last)) {}
+		while (!lt_cmper.lt(pivot, *++first)) {}
+	}
 
-		if (lt_cmper.lt(mid, *begin)) { UncheckedSwap(*begin, mid); }
+	*begin = Move(*last);
+	*last = Move(pivot);
 
-		if (lt_cmper.lt(*(end - Diff(1)), mid)) {
-			Value temp(Move(*(end - Diff(1))));
-			*(end - Diff(1)) = Move(mid);
+	return last;
+}
 
-			if (lt_cmper.lt(temp, *begin)) {
-				mid = Move(*begin);
-				*begin = Move(temp);
-			} else {
-				mid = Move(temp);
-			}
-		}
+/*
+ * Insertion sort [begin, end), giving up and returning false once more than
+ * PHI__partial_insertion_sort_limit elements have been moved. Needs an
+ * element not greater than any of [begin, end) right before begin.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+bool UnrestrictedPartialInsertionSort_(RandomAccessIterator begin,
+									   RandomAccessIterator end,
+									   LessThanComparer&& lt_cmper) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
 
-		UncheckedSwap(*(begin + Diff(1)), mid);
+	Diff moved(0);
 
-		RandomAccessIterator p(UnrestrictedPartition(
-			begin + Diff(2), end - Diff(1), *(begin + Diff(1)), lt_cmper));
+	for (RandomAccessIterator i(begin); i < end; ++i) {
+		RandomAccessIterator hole(i);
+		RandomAccessIterator hole_prev(i - Diff(1));
 
-		Swap(*(begin + Diff(1)), *(p - Diff(1)));
+		if (!lt_cmper.lt(*hole, *hole_prev)) { continue; }
 
-		Sort_n_is_three_(depth_limit, p, end, lt_cmper);
-		end = p - Diff(1);
-	}
-}
+		Value temp(Move(*hole));
 
-template<typename RandomAccessIterator,
+		do {
+			*hole = Move(*hole_prev);
+			hole = hole_prev;
+			--hole_prev;
+		} while (lt_cmper.lt(temp, *hole_prev));
+
+		*hole = Move(temp);
+
+		moved += i - hole;
+		if (Diff(PHI__partial_insertion_sort_limit) < moved) { return false; }
+	}
+
+	return true;
+}
+
+/*
+ * Swaps a few elements of a side left by a highly unbalanced partition into
+ * the places the next pivot is sampled from, so an adversarial pattern can not
+ * keep producing bad pivots.
+*/
+template<typename RandomAccessIterator>
+void SortBreakPatterns_(RandomAccessIterator begin, RandomAccessIterator end) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	Diff diff(end - begin);
+
+	if (diff < Diff(PHI__insertion_sort_threshold)) { return; }
+
+	Diff quarter(diff / Diff(4));
+
+	UncheckedSwap(*begin, *(begin + quarter));
+	UncheckedSwap(*(end - Diff(1)), *(end - quarter));
+
+	if (Diff(PHI__ninther_threshold) < diff) {
+		UncheckedSwap(*(begin + Diff(1)), *(begin + (quarter + Diff(1))));
+		UncheckedSwap(*(begin + Diff(2)), *(begin + (quarter + Diff(2))));
+		UncheckedSwap(*(end - Diff(2)), *(end - (quarter + Diff(1))));
+		UncheckedSwap(*(end - Diff(3)), *(end - (quarter + Diff(2))));
+	}
+}
+
+/*
+ * Pattern-defeating quicksort of [begin, end). Needs an element not greater
+ * than any of [begin, end) right before begin, which Sort sets up and every
+ * pivot keeps for the part on its right.
+ *
+ * If the pivot equals that element the pivot is the minimum, the elements
+ * equal to it are split off by PartitionLeft_ and are done, so many
+ * duplicates cost linear time. If a partition moved nothing, both sides are
+ * tried with a bounded insertion sort, which finishes sorted and nearly
+ * sorted input in linear time. Highly unbalanced partitions shuffle the
+ * sides, and after bad_allowed of them the range falls back to HeapSort.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+void Sort_(int bad_allowed, RandomAccessIterator begin,
+		   RandomAccessIterator end, LessThanComparer&& lt_cmper) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	for (;;) {
+		Diff diff(end - begin);
+
+		if (diff <= Diff(PHI__insertion_sort_threshold)) {
+			if constexpr (use_sorting_network_<Value, LessThanComparer>::value) {
+				if (SortingNetworkSort_(begin, end)) { return; }
+			}
+
+			UnrestrictedInsertionSort(begin, end, lt_cmper);
+			return;
+		}
+
+		SortChoosePivot_(begin, end, lt_cmper);
+
+		if (!lt_cmper.lt(*(begin - Diff(1)), *begin)) {
+			begin = PartitionLeft_(begin, end, lt_cmper) + Diff(1);
+			continue;
+		}
+
+		bool already_partitioned;
+		RandomAccessIterator p(
+			PartitionRight_(begin, end, already_partitioned, lt_cmper));
+
+		Diff l_diff(p - begin);
+		Diff r_diff(end - (p + Diff(1)));
+
+		if (l_diff < diff / Diff(8) || r_diff < diff / Diff(8)) {
+			if (--bad_allowed == 0) {
+				HeapSort(begin, end, lt_cmper);
+				return;
+			}
+
+			SortBreakPatterns_(begin, p);
+			SortBreakPatterns_(p + Diff(1), end);
+		} else if (already_partitioned &&
+				   UnrestrictedPartialInsertionSort_(begin, p, lt_cmper) &&
+				   UnrestrictedPartialInsertionSort_(p + Diff(1), end,
+													 lt_cmper)) {
+			return;
+		}
+
+		Sort_(bad_allowed, begin, p, lt_cmper);
+		begin = p + Diff(1);
+	}
+}
+
+template<typename RandomAccessIterator,
 		 typename LessThanComparer = DefaultLessThanComparer>
 void Sort(RandomAccessIterator begin, RandomAccessIterator end,
 		  LessThanComparer&& lt_cmper = LessThanComparer()) {
@@ -632,9 +1277,797 @@ void Sort(RandomAccessIterator begin, RandomAccessIterator end,
 	ConvolutionSwapIfDisorder(begin, end, lt_cmper);
 	begin = BubblePushReturnOrderedEnd(begin, end, lt_cmper);
 	if (!(begin < end)) { return; }
-	Sort_<false>(end - begin, begin, end, lt_cmper);
+	Sort_(log2int(end - begin), begin, end, lt_cmper);
+}
+
+/*
+ * Rearranges [begin, end) so begin[n] is the element a sort would put there,
+ * no element before it is greater and no element after it is less. Selects
+ * with the partitions of Sort, falling back to HeapSort after too many highly
+ * unbalanced ones.
+*/
+template<typename RandomAccessIterator,
+		 typename LessThanComparer = DefaultLessThanComparer>
+void Nth(typename iterator::trait<RandomAccessIterator>::Diff n,
+		 RandomAccessIterator begin, RandomAccessIterator end,
+		 LessThanComparer&& lt_cmper = LessThanComparer()) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	if (!(Diff(0) <= n && n < end - begin)) { return; }
+
+	bool leftmost(true);
+	int bad_allowed(log2int(end - begin));
+
+	for (;;) {
+		Diff diff(end - begin);
+
+		if (diff <= Diff(PHI__insertion_sort_threshold)) {
+			InsertionSort(begin, end, lt_cmper);
+			return;
+		}
+
+		SortChoosePivot_(begin, end, lt_cmper);
+
+		if (!leftmost && !lt_cmper.lt(*(begin - Diff(1)), *begin)) {
+			RandomAccessIterator p(PartitionLeft_(begin, end, lt_cmper));
+
+			// [begin, p] all equal the pivot
+			if (n <= p - begin) { return; }
+
+			n -= p - begin + Diff(1);
+			begin = p + Diff(1);
+
+			continue;
+		}
+
+		bool already_partitioned;
+		RandomAccessIterator p(
+			PartitionRight_(begin, end, already_partitioned, lt_cmper));
+
+		Diff l_diff(p - begin);
+		Diff r_diff(end - (p + Diff(1)));
+
+		if (l_diff < diff / Diff(8) || r_diff < diff / Diff(8)) {
+			if (--bad_allowed == 0) {
+				HeapSort(begin, end, lt_cmper);
+				return;
+			}
+
+			SortBreakPatterns_(begin, p);
+			SortBreakPatterns_(p + Diff(1), end);
+		}
+
+		if (n == l_diff) { return; }
+
+		if (n < l_diff) {
+			end = p;
+		} else {
+			n -= l_diff + Diff(1);
+			begin = p + Diff(1);
+			leftmost = false;
+		}
+	}
+}
+
+/*
+ * Rearranges [begin, end) so [begin, middle) holds the middle - begin least
+ * elements in sorted order. The rest is left in unspecified order. Selects
+ * with Nth first, so it takes O(n + k log k) for k = middle - begin.
+*/
+template<typename RandomAccessIterator,
+		 typename LessThanComparer = DefaultLessThanComparer>
+void PartialSort(RandomAccessIterator begin, RandomAccessIterator middle,
+				 RandomAccessIterator end,
+				 LessThanComparer&& lt_cmper = LessThanComparer()) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	if (!(begin < middle)) { return; }
+
+	if (!(middle < end)) {
+		Sort(begin, end, lt_cmper);
+		return;
+	}
+
+	Nth(middle - begin - Diff(1), begin, end, lt_cmper);
+	Sort(begin, middle - Diff(1), lt_cmper);
+}
+
+/*
+ * Copies the least min(end - begin, out_end - out_begin) elements of [begin,
+ * end) to out_begin in sorted order and returns the end of the output. The
+ * output is kept as a bounded max-heap, an element not less than its top is
+ * rejected with one comparison.
+*/
+template<typename InputIterator, typename RandomAccessIterator,
+		 typename LessThanComparer = DefaultLessThanComparer>
+RandomAccessIterator
+PartialSortCopy(InputIterator begin, InputIterator end,
+				RandomAccessIterator out_begin, RandomAccessIterator out_end,
+				LessThanComparer&& lt_cmper = LessThanComparer()) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	Diff capacity(out_end - out_begin);
+	Diff size(0);
+
+	for (; size < capacity && begin != end; ++begin, ++size) {
+		out_begin[size] = *begin;
+	}
+
+	if (size == Diff(0)) { return out_begin; }
+
+	heap::Make(out_begin, size, lt_cmper);
+
+	for (; begin != end; ++begin) {
+		if (!lt_cmper.lt(*begin, *out_begin)) { continue; }
+
+		// the top is dropped, sift a hole down from it
+		Value temp(*begin);
+		out_begin[heap::PushDownwardWithValue(out_begin, size, Diff(0), temp,
+											  lt_cmper)] = Move(temp);
+	}
+
+	heap::Sort(out_begin, size, lt_cmper);
+
+	return out_begin + size;
+}
+
+#undef PHI__partition_block_size
+#undef PHI__partial_insertion_sort_limit
+#undef PHI__ninther_threshold
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__stable_sort_min_run (32)
+#define PHI__stable_sort_min_gallop (7)
+
+/*
+ * Returns the first element of [begin, end) for which pred is false, pred
+ * should be true for a prefix of [begin, end) and false for the rest. Probes
+ * 1, 2, 4, ... elements from the front, or from the back if from_back, before
+ * the binary search, so the cost is logarithmic in the distance to the answer.
+*/
+template<typename RandomAccessIterator, typename Pred>
+RandomAccessIterator StableSortGallop_(RandomAccessIterator begin,
+									   RandomAccessIterator end, Pred&& pred,
+									   bool from_back) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	Diff lo(0);
+	Diff hi(end - begin);
+	Diff step(1);
+
+	if (from_back) {
+		while (step <= hi && !pred(*(begin + (hi - step)))) {
+			hi -= step;
+			step *= Diff(2);
+		}
+
+		if (step <= hi) { lo = hi - step + Diff(1); }
+	} else {
+		while (lo + step <= hi && pred(*(begin + (lo + step - Diff(1))))) {
+			lo += step;
+			step *= Diff(2);
+		}
+
+		if (lo + step <= hi) { hi = lo + step - Diff(1); }
+	}
+
+	while (lo < hi) {
+		Diff mid(lo + (hi - lo) / Diff(2));
+
+		if (pred(*(begin + mid))) {
+			lo = mid + Diff(1);
+		} else {
+			hi = mid;
+		}
+	}
+
+	return begin + lo;
+}
+
+template<typename RandomAccessIterator>
+RandomAccessIterator StableSortRotate_(RandomAccessIterator begin,
+									   RandomAccessIterator mid,
+									   RandomAccessIterator end) {
+	Reverse(begin, mid);
+	Reverse(mid, end);
+	Reverse(begin, end);
+	return begin + (end - mid);
 }
 
+/*
+ * Sorts [begin, end) by binary insertion, [begin, sorted_end) is sorted.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+void StableSortInsert_(RandomAccessIterator begin,
+					   RandomAccessIterator sorted_end,
+					   RandomAccessIterator end, LessThanComparer&& lt_cmper) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+
+	for (; sorted_end < end; ++sorted_end) {
+		Value temp(Move(*sorted_end));
+
+		RandomAccessIterator pos(StableSortGallop_(
+			begin, sorted_end,
+			[&](const Value& x) { return !lt_cmper.lt(temp, x); }, true));
+
+		for (RandomAccessIterator i(sorted_end); pos < i; --i) {
+			*i = Move(*(i - 1));
+		}
+
+		*pos = Move(temp);
+	}
+}
+
+/*
+ * Returns the end of the natural run starting at begin. A strictly descending
+ * run is reversed, so equal elements never swap.
+*/
+template<typename RandomAccessIterator, typename LessThanComparer>
+RandomAccessIterator StableSortRun_(RandomAccessIterator begin,
+									RandomAccessIterator end,
+									LessThanComparer&& lt_cmper) {
+	RandomAccessIterator i(begin + 1);
+	if (!(i < end)) { return end; }
+
+	if (lt_cmper.lt(*i, *begin)) {
+		do { ++i; } while (i < end && lt_cmper.lt(*i, *(i - 1)));
+		Reverse(begin, i);
+	} else {
+		do { ++i; } while (i < end && !lt_cmper.lt(*i, *(i - 1)));
+	}
+
+	return i;
+}
+
+/*
+ * Merges [begin, mid) into [mid, end) through buffer, which holds at least
+ * mid - begin elements, front to back.
+*/
+template<typename RandomAccessIterator, typename Value,
+		 typename LessThanComparer>
+void StableSortMergeLow_(RandomAccessIterator begin, RandomAccessIterator mid,
+						 RandomAccessIterator end, Value* buffer,
+						 LessThanComparer&& lt_cmper) {
+	size_t size(mid - begin);
+
+	for (size_t i(0); i != size; ++i) {
+		new (buffer + i) Value(Move(*(begin + i)));
+	}
+
+	Value* a(buffer);
+	Value* a_end(buffer + size);
+	RandomAccessIterator b(mid);
+	RandomAccessIterator out(begin);
+
+	size_t a_wins(0);
+	size_t b_wins(0);
+
+	while (a != a_end && b < end) {
+		if (lt_cmper.lt(*b, *a)) {
+			*out = Move(*b);
+			++b;
+			++b_wins;
+			a_wins = 0;
+		} else {
+			*out = Move(*a);
+			++a;
+			++a_wins;
+			b_wins = 0;
+		}
+
+		++out;
+
+		if (a == a_end || !(b < end)) { break; }
+
+		if (PHI__stable_sort_min_gallop <= a_wins) {
+			Value* stop(StableSortGallop_(
+				a, a_end, [&](const Value& x) { return !lt_cmper.lt(*b, x); },
+				false));
+
+			for (; a != stop; ++a, ++out) { *out = Move(*a); }
+
+			a_wins = 0;
+		} else if (PHI__stable_sort_min_gallop <= b_wins) {
+			RandomAccessIterator stop(StableSortGallop_(
+				b, end, [&](const Value& x) { return lt_cmper.lt(x, *a); },
+				false));
+
+			for (; b < stop; ++b, ++out) { *out = Move(*b); }
+
+			b_wins = 0;
+		}
+	}
+
+	for (; a != a_end; ++a, ++out) { *out = Move(*a); }
+
+	for (size_t i(0); i != size; ++i) { buffer[i].~Value(); }
+}
+
+/*
+ * Merges [mid, end) into [begin, mid) through buffer, which holds at least
+ * end - mid elements, back to front.
+*/
+template<typename RandomAccessIterator, typename Value,
+		 typename LessThanComparer>
+void StableSortMergeHigh_(RandomAccessIterator begin, RandomAccessIterator mid,
+						  RandomAccessIterator end, Value* buffer,
+						  LessThanComparer&& lt_cmper) {
+	size_t size(end - mid);
+
+	for (size_t i(0); i != size; ++i) {
+		new (buffer + i) Value(Move(*(mid + i)));
+	}
+
+	RandomAccessIterator a(mid);
+	Value* b(buffer + size);
+	RandomAccessIterator out(end);
+
+	size_t a_wins(0);
+	size_t b_wins(0);
+
+	while (begin < a && buffer != b) {
+		--out;
+
+		if (lt_cmper.lt(*(b - 1), *(a - 1))) {
+			--a;
+			*out = Move(*a);
+			++a_wins;
+			b_wins = 0;
+		} else {
+			--b;
+			*out = Move(*b);
+			++b_wins;
+			a_wins = 0;
+		}
+
+		if (!(begin < a) || buffer == b) { break; }
+
+		if (PHI__stable_sort_min_gallop <= a_wins) {
+			RandomAccessIterator stop(StableSortGallop_(
+				begin, a,
+				[&](const Value& x) { return !lt_cmper.lt(*(b - 1), x); },
+				true));
+
+			while (stop < a) { *--out = Move(*--a); }
+
+			a_wins = 0;
+		} else if (PHI__stable_sort_min_gallop <= b_wins) {
+			Value* stop(StableSortGallop_(
+				buffer, b,
+				[&](const Value& x) { return lt_cmper.lt(x, *(a - 1)); },
+				true));
+
+			while (stop != b) { *--out = Move(*--b); }
+
+			b_wins = 0;
+		}
+	}
+
+	while (buffer != b) { *--out = Move(*--b); }
+
+	for (size_t i(0); i != size; ++i) { buffer[i].~Value(); }
+}
+
+/*
+ * Merges the sorted [begin, mid) and [mid, end). The prefix of [begin, mid)
+ * and the suffix of [mid, end) already in place are skipped, then the shorter
+ * run goes through the buffer if it fits. Otherwise the longer run is split in
+ * half, the other at the matching position, and the middle parts are rotated
+ * into place before both halves are merged the same way.
+*/
+template<typename RandomAccessIterator, typename Value,
+		 typename LessThanComparer>
+void StableSortMerge_(RandomAccessIterator begin, RandomAccessIterator mid,
+					  RandomAccessIterator end, Value* buffer,
+					  size_t buffer_size, LessThanComparer&& lt_cmper) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	for (;;) {
+		if (!(begin < mid) || !(mid < end)) { return; }
+
+		begin = StableSortGallop_(
+			begin, mid, [&](const Value& x) { return !lt_cmper.lt(*mid, x); },
+			false);
+
+		if (!(begin < mid)) { return; }
+
+		end = StableSortGallop_(
+			mid, end,
+			[&](const Value& x) { return lt_cmper.lt(x, *(mid - Diff(1))); },
+			true);
+
+		Diff a_diff(mid - begin);
+		Diff b_diff(end - mid);
+
+		if (a_diff <= b_diff && size_t(a_diff) <= buffer_size) {
+			StableSortMergeLow_(begin, mid, end, buffer, lt_cmper);
+			return;
+		}
+
+		if (b_diff < a_diff && size_t(b_diff) <= buffer_size) {
+			StableSortMergeHigh_(begin, mid, end, buffer, lt_cmper);
+			return;
+		}
+
+		if (a_diff == Diff(1) && b_diff == Diff(1)) {
+			UncheckedSwap(*begin, *mid);
+			return;
+		}
+
+		RandomAccessIterator a_cut;
+		RandomAccessIterator b_cut;
+
+		if (b_diff < a_diff) {
+			a_cut = begin + a_diff / Diff(2);
+			b_cut = StableSortGallop_(
+				mid, end,
+				[&](const Value& x) { return lt_cmper.lt(x, *a_cut); }, false);
+		} else {
+			b_cut = mid + b_diff / Diff(2);
+			a_cut = StableSortGallop_(
+				begin, mid,
+				[&](const Value& x) { return !lt_cmper.lt(*b_cut, x); },
+				false);
+		}
+
+		RandomAccessIterator new_mid(StableSortRotate_(a_cut, mid, b_cut));
+
+		StableSortMerge_(begin, a_cut, new_mid, buffer, buffer_size, lt_cmper);
+
+		begin = new_mid;
+		mid = b_cut;
+	}
+}
+
+/*
+ * Returns the power of the boundary between the adjacent runs of size_a and
+ * size_b starting at offset in a range of size elements, the depth at which
+ * their midpoints separate when [0, size) is halved repeatedly.
+*/
+inline int StableSortPower_(size_t size, size_t offset, size_t size_a,
+							size_t size_b) {
+	size_t a(2 * offset + size_a);
+	size_t b(a + size_a + size_b);
+
+	int r(0);
+
+	for (;;) {
+		++r;
+
+		if (size <= a) {
+			a -= size;
+			b -= size;
+		} else if (size <= b) {
+			break;
+		}
+
+		a <<= 1;
+		b <<= 1;
+	}
+
+	return r;
+}
+
+/*
+ * Stable sort of [begin, end), equal elements keep their order.
+ *
+ * A powersort: natural runs are detected, descending ones reversed, and runs
+ * shorter than PHI__stable_sort_min_run are extended by binary insertion.
+ * Runs are merged in the order given by the powers of their boundaries, which
+ * keeps merges balanced and the cost within O(n log r) for r runs, so sorted
+ * and reverse sorted input takes linear time.
+ *
+ * Merges gallop once one run wins PHI__stable_sort_min_gallop times in a row.
+ * The buffer holds half the range, if it can not be allocated the merges
+ * fall back to rotations in place, O(n log n) each.
+*/
+template<typename RandomAccessIterator,
+		 typename LessThanComparer = DefaultLessThanComparer>
+void StableSort(RandomAccessIterator begin, RandomAccessIterator end,
+				LessThanComparer&& lt_cmper = LessThanComparer()) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	if (!(begin < end)) { return; }
+
+	size_t size(end - begin);
+
+	size_t buffer_size(size / 2);
+	Value* buffer(reinterpret_cast<Value*>(
+		new (std::nothrow) char[sizeof(Value) * buffer_size]));
+
+	if (buffer == nullptr) { buffer_size = 0; }
+
+	// runs waiting to be merged, each with the power of its boundary with the
+	// run after it, the powers are strictly increasing
+	size_t stack_begin[8 * sizeof(size_t) + 1];
+	int stack_power[8 * sizeof(size_t) + 1];
+	size_t stack_size(0);
+
+	RandomAccessIterator run_begin(begin);
+	RandomAccessIterator run_end(StableSortRun_(begin, end, lt_cmper));
+
+	for (;;) {
+		if (run_end - run_begin < Diff(PHI__stable_sort_min_run)) {
+			RandomAccessIterator run_stop(
+				end - run_begin <= Diff(PHI__stable_sort_min_run)
+					? end
+					: run_begin + Diff(PHI__stable_sort_min_run));
+
+			StableSortInsert_(run_begin, run_end, run_stop, lt_cmper);
+			run_end = run_stop;
+		}
+
+		if (!(run_end < end)) { break; }
+
+		RandomAccessIterator next_end(StableSortRun_(run_end, end, lt_cmper));
+
+		int power(StableSortPower_(size, run_begin - begin,
+								   run_end - run_begin, next_end - run_end));
+
+		while (stack_size != 0 && power < stack_power[stack_size - 1]) {
+			--stack_size;
+
+			RandomAccessIterator prev_begin(begin +
+											Diff(stack_begin[stack_size]));
+
+			StableSortMerge_(prev_begin, run_begin, run_end, buffer,
+							 buffer_size, lt_cmper);
+
+			run_begin = prev_begin;
+		}
+
+		stack_begin[stack_size] = run_begin - begin;
+		stack_power[stack_size] = power;
+		++stack_size;
+
+		run_begin = run_end;
+		run_end = next_end;
+	}
+
+	while (stack_size != 0) {
+		--stack_size;
+
+		RandomAccessIterator prev_begin(begin + Diff(stack_begin[stack_size]));
+
+		StableSortMerge_(prev_begin, run_begin, end, buffer, buffer_size,
+						 lt_cmper);
+
+		run_begin = prev_begin;
+	}
+
+	Free(buffer);
+}
+
+#undef PHI__stable_sort_min_gallop
+#undef PHI__stable_sort_min_run
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__parallel_sort_grain (1 << 16)
+
+/*
+ * Runs func(0), ..., func(thread_num - 1) on thread_num threads, the calling
+ * thread runs func(0).
+*/
+template<typename Func> void ParallelFor_(size_t thread_num, Func& func) {
+	std::thread* threads(Malloc<std::thread>(thread_num - 1));
+
+	for (size_t i(1); i < thread_num; ++i) {
+		new (threads + i - 1) std::thread([&func, i] { func(i); });
+	}
+
+	func(0);
+
+	for (size_t i(1); i < thread_num; ++i) {
+		threads[i - 1].join();
+		threads[i - 1].~thread();
+	}
+
+	Free(threads);
+}
+
+/*
+ * Moves the elements satisfying pred to the front of [begin, end) and returns
+ * the end of them. Not stable.
+*/
+template<typename RandomAccessIterator, typename Pred>
+RandomAccessIterator PartitionBy_(RandomAccessIterator begin,
+								  RandomAccessIterator end, Pred& pred) {
+	for (;;) {
+		while (begin != end && pred(*begin)) { ++begin; }
+
+		do {
+			if (begin == end) { return begin; }
+			--end;
+		} while (!pred(*end));
+
+		UncheckedSwap(*begin, *end);
+		++begin;
+	}
+}
+
+/*
+ * PartitionBy_ on thread_num threads. Every thread partitions its own chunk,
+ * then the misplaced elements, the satisfying ones behind the final boundary
+ * and the others before it, are paired up and the pairs are swapped by all
+ * threads again.
+*/
+template<typename RandomAccessIterator, typename Pred>
+RandomAccessIterator
+ParallelPartitionBy_(RandomAccessIterator begin, RandomAccessIterator end,
+					 Pred& pred, size_t thread_num) {
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	Diff diff(end - begin);
+
+	if (Diff(thread_num) > diff / Diff(PHI__parallel_sort_grain)) {
+		thread_num = size_t(diff / Diff(PHI__parallel_sort_grain));
+	}
+
+	if (thread_num <= 1) { return PartitionBy_(begin, end, pred); }
+
+	Diff* bounds(Malloc<Diff>(thread_num * 6 + 1));
+	Diff* mids(bounds + thread_num + 1);
+	Diff* l_begins(mids + thread_num); // satisfying ones behind the boundary
+	Diff* l_sizes(l_begins + thread_num);
+	Diff* r_begins(l_sizes + thread_num); // the others before the boundary
+	Diff* r_sizes(r_begins + thread_num);
+
+	for (size_t i(0); i <= thread_num; ++i) {
+		bounds[i] = diff * Diff(i) / Diff(thread_num);
+	}
+
+	auto partition_chunk = [&](size_t i) {
+		mids[i] =
+			PartitionBy_(begin + bounds[i], begin + bounds[i + 1], pred) -
+			begin;
+	};
+
+	ParallelFor_(thread_num, partition_chunk);
+
+	Diff boundary(0);
+
+	for (size_t i(0); i != thread_num; ++i) {
+		boundary += mids[i] - bounds[i];
+	}
+
+	size_t l_num(0);
+	size_t r_num(0);
+	Diff misplaced_num(0);
+
+	for (size_t i(0); i != thread_num; ++i) {
+		Diff l_begin(bounds[i] < boundary ? boundary : bounds[i]);
+
+		if (l_begin < mids[i]) {
+			l_begins[l_num] = l_begin;
+			l_sizes[l_num++] = mids[i] - l_begin;
+			misplaced_num += mids[i] - l_begin;
+		}
+
+		Diff r_end(boundary < bounds[i + 1] ? boundary : bounds[i + 1]);
+
+		if (mids[i] < r_end) {
+			r_begins[r_num] = mids[i];
+			r_sizes[r_num++] = r_end - mids[i];
+		}
+	}
+
+	auto swap_misplaced = [&](size_t t) {
+		Diff first(misplaced_num * Diff(t) / Diff(thread_num));
+		Diff last(misplaced_num * Diff(t + 1) / Diff(thread_num));
+
+		if (first == last) { return; }
+
+		size_t l(0);
+		Diff l_pos(first);
+		while (l_sizes[l] <= l_pos) { l_pos -= l_sizes[l++]; }
+
+		size_t r(0);
+		Diff r_pos(first);
+		while (r_sizes[r] <= r_pos) { r_pos -= r_sizes[r++]; }
+
+		for (Diff k(first); k != last; ++k) {
+			UncheckedSwap(*(begin + (l_begins[l] + l_pos)),
+						  *(begin + (r_begins[r] + r_pos)));
+
+			if (++l_pos == l_sizes[l]) {
+				++l;
+				l_pos = 0;
+			}
+
+			if (++r_pos == r_sizes[r]) {
+				++r;
+				r_pos = 0;
+			}
+		}
+	};
+
+	ParallelFor_(thread_num, swap_misplaced);
+
+	Free(bounds);
+
+	return begin + boundary;
+}
+
+template<typename RandomAccessIterator, typename LessThanComparer>
+void ParallelSort_(RandomAccessIterator begin, RandomAccessIterator end,
+				   LessThanComparer& lt_cmper, size_t thread_num) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using Diff = typename iterator::trait<RandomAccessIterator>::Diff;
+
+	Diff diff(end - begin);
+
+	if (thread_num <= 1 || diff < Diff(PHI__parallel_sort_grain)) {
+		Sort(begin, end, lt_cmper);
+		return;
+	}
+
+	// the median of 64 evenly spaced samples gathered at the front
+	Diff sample_num(64);
+
+	for (Diff i(0); i != sample_num; ++i) {
+		Swap(*(begin + i), *(begin + diff / sample_num * i));
+	}
+
+	Sort(begin, begin + sample_num, lt_cmper);
+
+	Value pivot(*(begin + sample_num / Diff(2)));
+
+	auto lt_pivot = [&](auto& x) { return lt_cmper.lt(x, pivot); };
+
+	RandomAccessIterator p(
+		ParallelPartitionBy_(begin, end, lt_pivot, thread_num));
+
+	if (p == begin) {
+		// pivot is the minimum, put the elements equal to it aside
+		auto le_pivot = [&](auto& x) { return !lt_cmper.lt(pivot, x); };
+		p = ParallelPartitionBy_(begin, end, le_pivot, thread_num);
+		ParallelSort_(p, end, lt_cmper, thread_num);
+		return;
+	}
+
+	size_t l_thread_num(size_t((p - begin) * Diff(thread_num) / diff));
+
+	if (l_thread_num == 0) {
+		l_thread_num = 1;
+	} else if (l_thread_num == thread_num) {
+		l_thread_num = thread_num - 1;
+	}
+
+	std::thread l_thread(
+		[&] { ParallelSort_(begin, p, lt_cmper, l_thread_num); });
+
+	ParallelSort_(p, end, lt_cmper, thread_num - l_thread_num);
+
+	l_thread.join();
+}
+
+/*
+ * Sorts [begin, end) on thread_num threads, 0 means hardware concurrency.
+ * Ranges are split by parallel partitioning around sampled pivots and every
+ * piece below PHI__parallel_sort_grain elements, or left with one thread, is
+ * finished by Sort. lt_cmper is shared by all threads, so lt_cmper.lt should
+ * be safe to call concurrently. Not stable.
+*/
+template<typename RandomAccessIterator,
+		 typename LessThanComparer = DefaultLessThanComparer>
+void ParallelSort(RandomAccessIterator begin, RandomAccessIterator end,
+				  LessThanComparer&& lt_cmper = LessThanComparer(),
+				  size_t thread_num = 0) {
+	if (thread_num == 0) { thread_num = std::thread::hardware_concurrency(); }
+	if (!(begin < end)) { return; }
+	ParallelSort_(begin, end, lt_cmper, thread_num);
+}
+
+#undef PHI__parallel_sort_grain
+
 #undef PHI__insertion_sort_threshold
 
 }
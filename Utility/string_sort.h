@@ -0,0 +1,380 @@
+#ifndef PHI__define_guard__Utility__string_sort_h
+#define PHI__define_guard__Utility__string_sort_h
+
+#include <cstring>
+
+#include "sort4.h"
+#include "pair.h"
+
+namespace phi {
+
+/*
+MultikeyQuickSort and StringRadixSort order elements by the byte string
+key_ext returns for them, bytes compared as unsigned and a proper prefix
+first, like memcmp followed by the lengths. Neither compares whole keys, a
+common prefix is looked at once per level rather than once per comparison,
+so n keys cost about O(n log n + D) byte reads for D the total length of the
+distinguishing prefixes instead of O(n log n L).
+
+Both sort an array of items holding the data pointer and length of each key
+next to a cached word, so the recursion never touches the elements, and then
+move the elements into place once.
+
+MultikeyQuickSort is the three-way radix quicksort of Bentley and Sedgewick.
+It partitions on a word caching 7 bytes of the key at the current depth
+rather than a single byte, with the number of bytes left, capped at 8, in the
+lowest byte, so a word order is the key order for those bytes and equal words
+with fewer than 8 bytes left mean equal keys.
+
+StringRadixSort distributes by one byte at a time, most significant first,
+into 257 buckets, the first one taking the keys that end at this depth.
+Buckets smaller than PHI__string_sort_radix_threshold are left to
+MultikeyQuickSort. Neither is stable.
+
+StringKey can be specialized for other key types, it should provide static
+const unsigned char* Data(const Key& key) and size_t Size(const Key& key).
+*/
+
+template<typename Key> struct StringKey {};
+
+template<typename Char> struct CharVectorStringKey_ {
+	static const unsigned char* Data(const cntr::Vector<Char>& key) {
+		return reinterpret_cast<const unsigned char*>(key.data());
+	}
+
+	static size_t Size(const cntr::Vector<Char>& key) { return key.size(); }
+};
+
+template<typename Char> struct CharSpanStringKey_ {
+	static const unsigned char* Data(const pair<Char*, size_t>& key) {
+		return reinterpret_cast<const unsigned char*>(key.first);
+	}
+
+	static size_t Size(const pair<Char*, size_t>& key) { return key.second; }
+};
+
+template<>
+struct StringKey<cntr::Vector<char>>: public CharVectorStringKey_<char> {};
+template<>
+struct StringKey<cntr::Vector<unsigned char>>:
+	public CharVectorStringKey_<unsigned char> {};
+
+template<>
+struct StringKey<pair<char*, size_t>>: public CharSpanStringKey_<char> {};
+template<>
+struct StringKey<pair<const char*, size_t>>:
+	public CharSpanStringKey_<const char> {};
+template<>
+struct StringKey<pair<unsigned char*, size_t>>:
+	public CharSpanStringKey_<unsigned char> {};
+template<>
+struct StringKey<pair<const unsigned char*, size_t>>:
+	public CharSpanStringKey_<const unsigned char> {};
+
+struct DefaultStringKeyExtractor {
+	template<typename T> const T& operator()(const T& x) const { return x; }
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+#define PHI__string_sort_insertion_sort_threshold (16)
+#define PHI__string_sort_radix_threshold (64)
+
+struct StringSortItem_ {
+	const unsigned char* data;
+	size_t size;
+	unsigned long long cache;
+	size_t index;
+};
+
+/*
+ * Caches the 7 bytes of item at depth, zero padded, above the number of bytes
+ * left capped at 8.
+*/
+inline void StringSortLoad_(StringSortItem_& item, size_t depth) {
+	size_t left(item.size - depth);
+	size_t n(left < 7 ? left : 7);
+
+	const unsigned char* data(item.data + depth);
+	unsigned long long cache(left < 8 ? left : 8);
+
+	for (size_t i(0); i != n; ++i) {
+		cache |= (unsigned long long)(data[i]) << (56 - 8 * i);
+	}
+
+	item.cache = cache;
+}
+
+/*
+ * Compares two items whose caches are loaded at depth.
+*/
+inline bool StringSortLess_(const StringSortItem_& x, const StringSortItem_& y,
+							size_t depth) {
+	if (x.cache != y.cache) { return x.cache < y.cache; }
+	if ((x.cache & 0xff) != 8) { return false; }
+
+	depth += 7;
+
+	size_t size(x.size < y.size ? x.size : y.size);
+
+	for (; depth != size; ++depth) {
+		if (x.data[depth] != y.data[depth]) {
+			return x.data[depth] < y.data[depth];
+		}
+	}
+
+	return x.size < y.size;
+}
+
+inline void StringSortInsertionSort_(StringSortItem_* items, size_t size,
+									 size_t depth) {
+	for (size_t i(1); i < size; ++i) {
+		if (!StringSortLess_(items[i], items[i - 1], depth)) { continue; }
+
+		StringSortItem_ temp(items[i]);
+		size_t j(i);
+
+		do {
+			items[j] = items[j - 1];
+		} while (--j != 0 && StringSortLess_(temp, items[j - 1], depth));
+
+		items[j] = temp;
+	}
+}
+
+inline void MultikeyQuickSort_(StringSortItem_* items, size_t size,
+							   size_t depth, bool loaded) {
+	for (;;) {
+		if (!loaded) {
+			for (size_t i(0); i != size; ++i) {
+				StringSortLoad_(items[i], depth);
+			}
+		}
+
+		if (size <= PHI__string_sort_insertion_sort_threshold) {
+			StringSortInsertionSort_(items, size, depth);
+			return;
+		}
+
+		// median of three caches
+		{
+			unsigned long long a(items[0].cache);
+			unsigned long long b(items[size / 2].cache);
+			unsigned long long c(items[size - 1].cache);
+
+			size_t m(a < b ? (b < c ? size / 2 : (a < c ? size - 1 : 0))
+						   : (a < c ? 0 : (b < c ? size - 1 : size / 2)));
+
+			UncheckedSwap(items[0], items[m]);
+		}
+
+		unsigned long long pivot(items[0].cache);
+
+		// [0, lt) less, [lt, i) equal, [gt, size) greater
+		size_t lt(0);
+		size_t i(1);
+		size_t gt(size);
+
+		while (i < gt) {
+			unsigned long long cache(items[i].cache);
+
+			if (cache < pivot) {
+				UncheckedSwap(items[lt++], items[i++]);
+			} else if (pivot < cache) {
+				UncheckedSwap(items[i], items[--gt]);
+			} else {
+				++i;
+			}
+		}
+
+		size_t eq_size(gt - lt);
+		size_t gt_size(size - gt);
+
+		// every equal key ends here, the group is done
+		if ((pivot & 0xff) != 8) { eq_size = 0; }
+
+		// recurse into the smaller parts and loop on the largest
+		if (eq_size < lt || eq_size < gt_size) {
+			if (eq_size != 0) {
+				MultikeyQuickSort_(items + lt, eq_size, depth + 7, false);
+			}
+
+			if (lt < gt_size) {
+				MultikeyQuickSort_(items, lt, depth, true);
+				items += gt;
+				size = gt_size;
+			} else {
+				MultikeyQuickSort_(items + gt, gt_size, depth, true);
+				size = lt;
+			}
+
+			loaded = true;
+		} else {
+			MultikeyQuickSort_(items, lt, depth, true);
+			MultikeyQuickSort_(items + gt, gt_size, depth, true);
+			items += lt;
+			size = eq_size;
+			depth += 7;
+			loaded = false;
+		}
+	}
+}
+
+/*
+ * Returns the length of the prefix every item shares beyond depth, comparing
+ * 8 bytes at a time.
+*/
+inline size_t StringSortCommonPrefix_(const StringSortItem_* items, size_t size,
+									  size_t depth) {
+	const unsigned char* first(items[0].data + depth);
+	size_t r(items[0].size - depth);
+
+	for (size_t i(1); r != 0 && i != size; ++i) {
+		const unsigned char* data(items[i].data + depth);
+		size_t n(items[i].size - depth < r ? items[i].size - depth : r);
+		size_t k(0);
+
+		while (k + 8 <= n && std::memcmp(first + k, data + k, 8) == 0) {
+			k += 8;
+		}
+
+		while (k != n && first[k] == data[k]) { ++k; }
+
+		r = k;
+	}
+
+	return r;
+}
+
+inline void StringRadixSort_(StringSortItem_* items, StringSortItem_* buffer,
+							 size_t size, size_t depth) {
+	for (;;) {
+		if (size < PHI__string_sort_radix_threshold) {
+			MultikeyQuickSort_(items, size, depth, false);
+			return;
+		}
+
+		size_t count[257];
+		Fill(count, count + 257, size_t(0));
+
+		for (size_t i(0); i != size; ++i) {
+			const StringSortItem_& item(items[i]);
+			++count[depth < item.size ? item.data[depth] + 1 : 0];
+		}
+
+		// skip the prefix every key shares without moving anything
+		size_t bucket(0);
+		while (count[bucket] == 0) { ++bucket; }
+
+		if (count[bucket] == size) {
+			if (bucket == 0) { return; }
+			depth += 1 + StringSortCommonPrefix_(items, size, depth + 1);
+			continue;
+		}
+
+		size_t offset[257];
+		offset[0] = 0;
+
+		for (size_t b(1); b != 257; ++b) {
+			offset[b] = offset[b - 1] + count[b - 1];
+		}
+
+		for (size_t i(0); i != size; ++i) {
+			const StringSortItem_& item(items[i]);
+			buffer[offset[depth < item.size ? item.data[depth] + 1 : 0]++] =
+				item;
+		}
+
+		for (size_t i(0); i != size; ++i) { items[i] = buffer[i]; }
+
+		size_t largest(1);
+
+		for (size_t b(2); b != 257; ++b) {
+			if (count[largest] < count[b]) { largest = b; }
+		}
+
+		// the keys of bucket 0 have ended and are equal, recurse into the
+		// other buckets and loop on the largest
+		size_t begin(count[0]);
+		size_t largest_begin(0);
+
+		for (size_t b(1); b != 257; ++b) {
+			if (b == largest) {
+				largest_begin = begin;
+			} else if (1 < count[b]) {
+				StringRadixSort_(items + begin, buffer, count[b], depth + 1);
+			}
+
+			begin += count[b];
+		}
+
+		items += largest_begin;
+		size = count[largest];
+		++depth;
+	}
+}
+
+template<typename RandomAccessIterator, typename KeyExtractor, typename Sorter>
+void StringSort_(RandomAccessIterator begin, RandomAccessIterator end,
+				 KeyExtractor& key_ext, Sorter sorter) {
+	using Value = typename iterator::trait<RandomAccessIterator>::Value;
+	using Key = typename remove_reference_and_const<decltype(
+		key_ext(*begin))>::type;
+
+	if (!(begin < end)) { return; }
+
+	size_t size(end - begin);
+
+	StringSortItem_* items(Malloc<StringSortItem_>(size));
+
+	for (size_t i(0); i != size; ++i) {
+		const Key& key(key_ext(begin[i]));
+		items[i].data = StringKey<Key>::Data(key);
+		items[i].size = StringKey<Key>::Size(key);
+		items[i].index = i;
+	}
+
+	sorter(items, size);
+
+	Value* buffer(Malloc<Value>(size));
+
+	for (size_t i(0); i != size; ++i) {
+		new (buffer + i) Value(Move(begin[items[i].index]));
+	}
+
+	for (size_t i(0); i != size; ++i) { begin[i] = Move(buffer[i]); }
+
+	Delete(size, buffer);
+	Free(items);
+}
+
+template<typename RandomAccessIterator,
+		 typename KeyExtractor = DefaultStringKeyExtractor>
+void MultikeyQuickSort(RandomAccessIterator begin, RandomAccessIterator end,
+					   KeyExtractor&& key_ext = KeyExtractor()) {
+	StringSort_(begin, end, key_ext,
+				[](StringSortItem_* items, size_t size) {
+					MultikeyQuickSort_(items, size, 0, false);
+				});
+}
+
+template<typename RandomAccessIterator,
+		 typename KeyExtractor = DefaultStringKeyExtractor>
+void StringRadixSort(RandomAccessIterator begin, RandomAccessIterator end,
+					 KeyExtractor&& key_ext = KeyExtractor()) {
+	StringSort_(begin, end, key_ext,
+				[](StringSortItem_* items, size_t size) {
+					StringSortItem_* buffer(Malloc<StringSortItem_>(size));
+					StringRadixSort_(items, buffer, size, 0);
+					Free(buffer);
+				});
+}
+
+#undef PHI__string_sort_radix_threshold
+#undef PHI__string_sort_insertion_sort_threshold
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef PHI__define_guard__Utility__top_k_h
+#define PHI__define_guard__Utility__top_k_h
+
+#include "sort4.h"
+
+namespace phi {
+
+/*
+TopK keeps the K least Values pushed to it, least by LessThanComparer, so pass
+a greater-than comparer for the K greatest. Memory is bounded by 2K Values
+whatever the length of the stream.
+
+Candidates are appended to a buffer of 2K. When it fills, Nth moves the K
+least to the front and drops the rest, and the greatest kept Value becomes the
+threshold. From then on a Value not less than the threshold is rejected with
+one comparison. A prune costs O(K) and happens at most once per K accepted
+Values, so a stream of n Values costs O(n) plus O(K log K) for the final Sort,
+also on adversarial inputs where a bounded heap would pay log K per Value.
+
+The batch Push compares eight or four Values against the threshold at a time
+with AVX2 for arithmetic Values under DefaultLessThanComparer, and only
+the lanes that pass are pushed one by one.
+*/
+
+template<typename Value, size_t K,
+		 typename LessThanComparer = DefaultLessThanComparer>
+class TopK {
+public:
+	static_assert(K != 0, "K error");
+
+	size_t size() const;
+	bool empty() const;
+
+	const Value& threshold() const;
+	bool has_threshold() const;
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	TopK(const LessThanComparer& lt_cmper = LessThanComparer());
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	template<typename V> bool Push(V&& value);
+
+	void Push(const Value* values, size_t size);
+
+	void Clear();
+
+#///////////////////////////////////////////////////////////////////////////////
+
+	const Value* Sort();
+
+private:
+	size_t size_;
+	bool pruned_;
+
+	Value buffer_[2 * K];
+
+	LessThanComparer lt_cmper_;
+
+	void Prune_();
+};
+
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Value, size_t K, typename LessThanComparer>
+size_t TopK<Value, K, LessThanComparer>::size() const {
+	return this->size_ < K ? this->size_ : K;
+}
+
+template<typename Value, size_t K, typename LessThanComparer>
+bool TopK<Value, K, LessThanComparer>::empty() const {
+	return this->size_ == 0;
+}
+
+/*
+ * The greatest Value kept by the last prune. Only valid if has_threshold().
+*/
+template<typename Value, size_t K, typename LessThanComparer>
+const Value& TopK<Value, K, LessThanComparer>::threshold() const {
+	PHI__debug_if(!this->pruned_) { PHI__throw("no threshold"); }
+	return this->buffer_[K - 1];
+}
+
+template<typename Value, size_t K, typename LessThanComparer>
+bool TopK<Value, K, LessThanComparer>::has_threshold() const {
+	return this->pruned_;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Value, size_t K, typename LessThanComparer>
+TopK<Value, K, LessThanComparer>::TopK(const LessThanComparer& lt_cmper):
+	size_(0), pruned_(false), lt_cmper_(lt_cmper) {}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+template<typename Value, size_t K, typename LessThanComparer>
+void TopK<Value, K, LessThanComparer>::Prune_() {
+	Nth(K - 1, this->buffer_, this->buffer_ + this->size_, this->lt_cmper_);
+	this->size_ = K;
+	this->pruned_ = true;
+}
+
+/*
+ * Returns false if value was rejected by the threshold.
+*/
+template<typename Value, size_t K, typename LessThanComparer>
+template<typename V>
+bool TopK<Value, K, LessThanComparer>::Push(V&& value) {
+	if (this->pruned_ && !this->lt_cmper_.lt(value, this->buffer_[K - 1])) {
+		return false;
+	}
+
+	if (this->size_ == 2 * K) {
+		this->Prune_();
+
+		if (!this->lt_cmper_.lt(value, this->buffer_[K - 1])) { return false; }
+	}
+
+	this->buffer_[this->size_++] = Forward<V>(value);
+
+	return true;
+}
+
+template<typename Value, size_t K, typename LessThanComparer>
+void TopK<Value, K, LessThanComparer>::Push(const Value* values, size_t size) {
+	size_t i(0);
+
+#if defined(__AVX2__)
+	if constexpr (use_sorting_network_<Value, LessThanComparer>::value) {
+		using V = SortingNetworkVector_<Value>;
+
+		while (i != size && !this->pruned_) { this->Push(values[i++]); }
+
+		for (; i + V::width <= size; i += V::width) {
+			int mask(V::LessMask(V::Load(values + i),
+								 V::Broadcast(this->buffer_[K - 1])));
+
+			for (; mask != 0; mask &= mask - 1) {
+				this->Push(values[i + __builtin_ctz(mask)]);
+			}
+		}
+	}
+#endif
+
+	for (; i != size; ++i) { this->Push(values[i]); }
+}
+
+template<typename Value, size_t K, typename LessThanComparer>
+void TopK<Value, K, LessThanComparer>::Clear() {
+	this->size_ = 0;
+	this->pruned_ = false;
+}
+
+#///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Sorts the kept Values and returns them, size() of them. Pushing may go on
+ * afterwards.
+*/
+template<typename Value, size_t K, typename LessThanComparer>
+const Value* TopK<Value, K, LessThanComparer>::Sort() {
+	if (K < this->size_) { this->Prune_(); }
+
+	phi::Sort(this->buffer_, this->buffer_ + this->size_, this->lt_cmper_);
+
+	// the last of K sorted Values is as good a threshold as a prune gives
+	if (this->size_ == K) { this->pruned_ = true; }
+
+	return this->buffer_;
+}
+
+}
+
+#endif